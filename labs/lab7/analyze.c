@@ -0,0 +1,310 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "analyze.h"
+#include "stackdist.h"
+#include "trace.h"
+
+#define TRUE 1
+#define FALSE 0
+
+#define MAX_WINDOWS 16
+#define MAX_PROCESSES 4
+
+// Distinct pages among the last size references of one process. ring holds
+// the key of each of those references, by reference number modulo size.
+struct Window
+{
+    int size;
+    int *ring;
+    int distinct;
+    uint64_t sum; // of distinct after every reference, for the mean
+    int peak;
+};
+
+// A page and its reference count, for the ranking
+struct PageCount
+{
+    int key;
+    uint64_t count;
+};
+
+static int parse_windows(const char *list, int *values)
+{
+    int count = 0;
+    const char *p = list;
+    while (*p != '\0')
+    {
+        char *end;
+        long value = strtol(p, &end, 10);
+        if (end == p || value < 1 || count == MAX_WINDOWS || (*end != ',' && *end != '\0'))
+        {
+            return -1;
+        }
+        values[count++] = (int)value;
+        p = (*end == ',') ? end + 1 : end;
+    }
+    return count;
+}
+
+// Most referenced first, then by process and VPN
+static int compare_counts(const void *a, const void *b)
+{
+    const struct PageCount *x = a;
+    const struct PageCount *y = b;
+    if (x->count != y->count)
+    {
+        return x->count > y->count ? -1 : 1;
+    }
+    return x->key - y->key;
+}
+
+// Record reference number now of a process to key. last holds, per key, the
+// number of its previous reference, 0 if none.
+static void window_reference(struct Window *w, const uint64_t *last, int key, uint64_t now)
+{
+    int slot = now % w->size;
+    if (now > (uint64_t)w->size)
+    {
+        // the reference leaving the window was the last one to its page
+        int old = w->ring[slot];
+        if (last[old] == now - w->size)
+        {
+            w->distinct--;
+        }
+    }
+    if (last[key] == 0 || last[key] + w->size <= now)
+    {
+        w->distinct++;
+    }
+    w->ring[slot] = key;
+    w->sum += w->distinct;
+    if (w->distinct > w->peak)
+    {
+        w->peak = w->distinct;
+    }
+}
+
+int analyze(FILE *input, FILE *output, struct AnalyzeConfig *config)
+{
+    int window_sizes[MAX_WINDOWS];
+    int num_windows = parse_windows(config->windows, window_sizes);
+    if (num_windows <= 0 || config->hot_pages < 0)
+    {
+        fprintf(stderr, "Error: malformed analysis configuration\n");
+        return -1;
+    }
+
+    struct Window windows[MAX_PROCESSES][MAX_WINDOWS];
+    memset(windows, 0, sizeof(windows));
+    uint64_t references[MAX_PROCESSES] = {0};
+
+    // 32 buckets of LRU stack depths: depth 1, then (2^(b-1), 2^b]
+    uint64_t depths[32] = {0};
+    uint64_t cold = 0;
+    struct StackDist stack;
+
+    char buffer[1024];
+    int memory_initialized = FALSE;
+    int current_process = 0;
+    int off = 0;
+    int num_pages = 0;
+    int num_keys = 0;
+    uint64_t *last = NULL;   // per process and VPN, see window_reference
+    uint64_t *counts = NULL; // per process and VPN
+    int status = 0;
+
+    while (trace_gets(buffer, sizeof(buffer), input) != NULL)
+    {
+        if (buffer[0] == '%')
+        {
+            continue;
+        }
+
+        char *op = strtok(buffer, " \n");
+        char *arg1 = op ? strtok(NULL, " \n") : NULL;
+        char *arg2 = arg1 ? strtok(NULL, " \n") : NULL;
+        if (op == NULL)
+        {
+            continue;
+        }
+
+        if (strcmp(op, "define") == 0)
+        {
+            char *arg3 = arg2 ? strtok(NULL, " \n") : NULL;
+            if (memory_initialized || arg3 == NULL)
+            {
+                fprintf(stderr, "Error: invalid define\n");
+                status = -1;
+                break;
+            }
+            off = atoi(arg1);
+            num_pages = 1 << atoi(arg3);
+            num_keys = MAX_PROCESSES * num_pages;
+            last = calloc(num_keys, sizeof(uint64_t));
+            counts = calloc(num_keys, sizeof(uint64_t));
+            if (last == NULL || counts == NULL || stackdist_init(&stack, num_keys) != 0)
+            {
+                fprintf(stderr, "Error: out of memory\n");
+                status = -1;
+                break;
+            }
+            memory_initialized = TRUE;
+
+            int allocated = TRUE;
+            for (int pid = 0; pid < MAX_PROCESSES; pid++)
+            {
+                for (int i = 0; i < num_windows; i++)
+                {
+                    windows[pid][i].size = window_sizes[i];
+                    windows[pid][i].ring = malloc(window_sizes[i] * sizeof(int));
+                    allocated = allocated && windows[pid][i].ring != NULL;
+                }
+            }
+            if (!allocated)
+            {
+                fprintf(stderr, "Error: out of memory\n");
+                status = -1;
+                break;
+            }
+            continue;
+        }
+
+        if (strcmp(op, "ctxswitch") == 0)
+        {
+            int new_pid = arg1 ? atoi(arg1) : -1;
+            if (new_pid < 0 || new_pid >= MAX_PROCESSES)
+            {
+                fprintf(stderr, "Error: invalid context switch to process %d\n", new_pid);
+                status = -1;
+                break;
+            }
+            current_process = new_pid;
+            continue;
+        }
+
+        int is_store = strcmp(op, "store") == 0;
+        int is_load = strcmp(op, "load") == 0;
+        if (!is_store && !is_load)
+        {
+            continue;
+        }
+        if (!memory_initialized)
+        {
+            fprintf(stderr, "Error: %s before define\n", op);
+            status = -1;
+            break;
+        }
+
+        char *address = is_load ? arg2 : arg1;
+        if (address == NULL)
+        {
+            fprintf(stderr, "Error: malformed %s instruction\n", op);
+            status = -1;
+            break;
+        }
+        if (is_load && address[0] == '#')
+        {
+            continue;
+        }
+        int vpn = atoi(address) >> off;
+        if (vpn < 0 || vpn >= num_pages)
+        {
+            continue;
+        }
+
+        int key = current_process * num_pages + vpn;
+        uint64_t now = ++references[current_process];
+        for (int i = 0; i < num_windows; i++)
+        {
+            window_reference(&windows[current_process][i], last, key, now);
+        }
+        last[key] = now;
+        counts[key]++;
+
+        int depth = stackdist_access(&stack, key);
+        if (depth < 0)
+        {
+            fprintf(stderr, "Error: could not grow the LRU stack\n");
+            status = -1;
+            break;
+        }
+        if (depth == 0)
+        {
+            cold++;
+        }
+        else
+        {
+            depths[depth == 1 ? 0 : 32 - __builtin_clz(depth - 1)]++;
+        }
+    }
+
+    if (status == 0)
+    {
+        uint64_t total = 0;
+        fprintf(output, "pid,window,references,mean_working_set,peak_working_set\n");
+        for (int pid = 0; pid < MAX_PROCESSES; pid++)
+        {
+            total += references[pid];
+            for (int i = 0; references[pid] > 0 && i < num_windows; i++)
+            {
+                struct Window *w = &windows[pid][i];
+                fprintf(output, "%d,%d,%llu,%.2f,%d\n", pid, w->size, (unsigned long long)references[pid],
+                        (double)w->sum / references[pid], w->peak);
+            }
+        }
+
+        uint64_t hits = 0;
+        fprintf(output, "\nmin_distance,max_distance,references,fraction,lru_hit_rate\n");
+        for (int b = 0; b < 32; b++)
+        {
+            if (depths[b] == 0)
+            {
+                continue;
+            }
+            hits += depths[b];
+            long long low = b == 0 ? 1 : (1LL << (b - 1)) + 1;
+            fprintf(output, "%lld,%lld,%llu,%.6f,%.6f\n", low, 1LL << b, (unsigned long long)depths[b],
+                    (double)depths[b] / total, (double)hits / total);
+        }
+        fprintf(output, "cold,cold,%llu,%.6f,%.6f\n", (unsigned long long)cold,
+                total ? (double)cold / total : 0.0, total ? (double)hits / total : 0.0);
+
+        fprintf(output, "\nrank,pid,vpn,references,fraction\n");
+        struct PageCount *ranking = malloc((num_keys + 1) * sizeof(struct PageCount));
+        int num_ranked = 0;
+        for (int key = 0; ranking != NULL && key < num_keys; key++)
+        {
+            if (counts[key] > 0)
+            {
+                ranking[num_ranked++] = (struct PageCount){key, counts[key]};
+            }
+        }
+        if (ranking != NULL)
+        {
+            qsort(ranking, num_ranked, sizeof(struct PageCount), compare_counts);
+        }
+        for (int i = 0; i < num_ranked && i < config->hot_pages; i++)
+        {
+            fprintf(output, "%d,%d,%d,%llu,%.6f\n", i + 1, ranking[i].key / num_pages, ranking[i].key % num_pages,
+                    (unsigned long long)ranking[i].count, (double)ranking[i].count / total);
+        }
+        free(ranking);
+    }
+
+    for (int pid = 0; pid < MAX_PROCESSES; pid++)
+    {
+        for (int i = 0; i < num_windows; i++)
+        {
+            free(windows[pid][i].ring);
+        }
+    }
+    if (memory_initialized)
+    {
+        stackdist_free(&stack);
+    }
+    free(last);
+    free(counts);
+    return status;
+}
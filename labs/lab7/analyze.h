@@ -0,0 +1,32 @@
+#ifndef __analyze_h__
+#define __analyze_h__
+
+#include <stdio.h>
+
+struct AnalyzeConfig
+{
+    const char *windows; // comma-separated working-set windows, in references
+    int hot_pages;       // number of most referenced pages to list
+};
+
+#define ANALYZE_DEFAULT_WINDOWS "100,1000,10000"
+#define ANALYZE_DEFAULT_HOT_PAGES 10
+
+// Characterize the page references of a trace in a single pass, and write
+// three CSV tables separated by blank lines:
+//
+// - the mean and peak working-set size of every process for each window,
+//   the distinct pages among its last N references, counted in the
+//   process's own references;
+// - the histogram of LRU stack distances over all processes, in power of
+//   two buckets, with the hit rate of a fully associative LRU TLB of each
+//   bucket's upper size;
+// - the most referenced pages.
+//
+// A reference is the memory operand of a load or store, whether mapped or
+// not. Memory grows with the number of pages and the sum of the windows,
+// not with the length of the trace. Return 0 on success, -1 on a malformed
+// configuration or trace.
+int analyze(FILE *input, FILE *output, struct AnalyzeConfig *config);
+
+#endif
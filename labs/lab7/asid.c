@@ -0,0 +1,65 @@
+#include <stdlib.h>
+#include <string.h>
+#include "asid.h"
+
+#define TRUE 1
+#define FALSE 0
+
+int asid_parse(const char *mode, int *size)
+{
+    if (strcmp(mode, "tagged") == 0)
+    {
+        *size = ASID_TAGGED;
+        return 0;
+    }
+    if (strcmp(mode, "flush") == 0)
+    {
+        *size = ASID_FLUSH;
+        return 0;
+    }
+
+    char *end;
+    long value = strtol(mode, &end, 10);
+    if (end == mode || *end != '\0' || value < 1)
+    {
+        return -1;
+    }
+    // a pool with a tag for every process never recycles
+    *size = value >= MAX_PROCESSES ? ASID_TAGGED : (int)value;
+    return 0;
+}
+
+void asid_init(struct ASIDPool *pool, int size, int first_pid)
+{
+    memset(pool, 0, sizeof(*pool));
+    pool->size = size;
+    pool->has_asid[first_pid] = TRUE;
+    pool->holders = 1;
+}
+
+int asid_switch(struct ASIDPool *pool, int pid, uint32_t timestamp)
+{
+    int victim = -1;
+
+    if (pool->size != ASID_TAGGED && !pool->has_asid[pid])
+    {
+        if (pool->holders == pool->size)
+        {
+            // recycle the ASID of the least recently scheduled holder
+            for (int p = 0; p < MAX_PROCESSES; p++)
+            {
+                if (pool->has_asid[p] && (victim == -1 || pool->last_scheduled[p] < pool->last_scheduled[victim]))
+                {
+                    victim = p;
+                }
+            }
+            pool->has_asid[victim] = FALSE;
+            pool->holders--;
+        }
+        pool->has_asid[pid] = TRUE;
+        pool->holders++;
+    }
+
+    pool->last_scheduled[pid] = timestamp;
+    return victim;
+}
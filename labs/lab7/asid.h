@@ -0,0 +1,37 @@
+#ifndef __asid_h__
+#define __asid_h__
+
+#include <stdint.h>
+
+#define MAX_PROCESSES 4
+
+// Address-space identifiers handed out on context switches. TLB entries are
+// tagged with their process, which is equivalent to tagging them with the
+// process' ASID as long as an ASID's entries are flushed when it is recycled.
+//
+//   size 0            every process keeps its own tag (entries survive switches)
+//   size 1            a single tag: the TLB is flushed on every switch
+//   size 2 .. 3       a limited pool; the least recently scheduled process
+//                     loses its ASID, and its entries, to the incoming one
+struct ASIDPool
+{
+    int size;
+    int holders;
+    int has_asid[MAX_PROCESSES];
+    uint32_t last_scheduled[MAX_PROCESSES];
+};
+
+#define ASID_TAGGED 0
+#define ASID_FLUSH 1
+
+// Parse "tagged", "flush" or a pool size. Return 0 on success, -1 otherwise.
+int asid_parse(const char *mode, int *size);
+
+// Start with first_pid scheduled
+void asid_init(struct ASIDPool *pool, int size, int first_pid);
+
+// Schedule pid. Return the process whose TLB entries must be flushed because
+// its ASID was recycled, or -1 if none.
+int asid_switch(struct ASIDPool *pool, int pid, uint32_t timestamp);
+
+#endif
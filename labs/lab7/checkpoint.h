@@ -0,0 +1,24 @@
+#ifndef __checkpoint_h__
+#define __checkpoint_h__
+
+#include <stdio.h>
+
+// Checkpoints are raw dumps of the simulator state in the byte order and
+// type sizes of the machine that wrote them; they are meant to be resumed
+// by the same build. Every module writes its own blocks in a fixed order.
+
+#define CHECKPOINT_MAGIC "MEMSYMCK"
+#define CHECKPOINT_VERSION 1
+
+// Write or read size bytes. Return 0 on success, -1 otherwise.
+static inline int checkpoint_write(FILE *file, const void *data, size_t size)
+{
+    return fwrite(data, 1, size, file) == size ? 0 : -1;
+}
+
+static inline int checkpoint_read(FILE *file, void *data, size_t size)
+{
+    return fread(data, 1, size, file) == size ? 0 : -1;
+}
+
+#endif
@@ -0,0 +1,28 @@
+#include <stdlib.h>
+#include "cost.h"
+
+// Parse a non-negative cycle count ending at delimiter. Return a pointer past
+// the delimiter, or NULL.
+static const char *parse_latency(const char *s, char delimiter, uint32_t *value)
+{
+    char *end;
+    long n = strtol(s, &end, 10);
+    if (end == s || *end != delimiter || n < 0)
+    {
+        return NULL;
+    }
+    *value = (uint32_t)n;
+    return end + 1;
+}
+
+int cost_parse(const char *spec, struct CostModel *model)
+{
+    const char *s = spec;
+    if ((s = parse_latency(s, ',', &model->tlb_hit)) == NULL ||
+        (s = parse_latency(s, ',', &model->walk_level)) == NULL ||
+        parse_latency(s, '\0', &model->memory) == NULL)
+    {
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,31 @@
+#ifndef __cost_h__
+#define __cost_h__
+
+#include <stdint.h>
+
+// Latencies, in cycles, of the steps of a memory reference. Every reference
+// probes the TLB; a miss walks the page table, one memory read per level;
+// a reference that translates then accesses memory.
+struct CostModel
+{
+    uint32_t tlb_hit;
+    uint32_t walk_level;
+    uint32_t memory;
+    int levels;
+};
+
+#define COST_DEFAULT_SPEC "1,20,100"
+#define COST_DEFAULT_LEVELS 1
+
+// Parse "HIT,WALK,MEMORY" latencies into model, leaving levels unchanged.
+// Return 0 on success, -1 otherwise.
+int cost_parse(const char *spec, struct CostModel *model);
+
+// Total cycles of references that all probed the TLB, of which misses walked
+// the page table and accesses reached memory
+static inline uint64_t cost_cycles(const struct CostModel *model, uint64_t references, uint64_t misses, uint64_t accesses)
+{
+    return references * model->tlb_hit + misses * (uint64_t)model->levels * model->walk_level + accesses * model->memory;
+}
+
+#endif
@@ -0,0 +1,221 @@
+#include <stdlib.h>
+#include <string.h>
+#include "frames.h"
+#include "checkpoint.h"
+
+#define TRUE 1
+#define FALSE 0
+
+static const char *policy_names[NUM_FRAME_POLICIES] = {"LRU", "CLOCK", "WS"};
+
+int frames_parse_policy(const char *name, enum FramePolicy *policy)
+{
+    for (int i = 0; i < NUM_FRAME_POLICIES; i++)
+    {
+        if (strcmp(name, policy_names[i]) == 0)
+        {
+            *policy = i;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+int frames_init(struct FramePool *pool, int num_frames, enum FramePolicy policy, uint32_t window)
+{
+    pool->frames = malloc(num_frames * sizeof(struct Frame));
+    pool->free_list = malloc(num_frames * sizeof(int));
+    if (pool->frames == NULL || pool->free_list == NULL)
+    {
+        frames_free(pool);
+        return -1;
+    }
+
+    pool->num_frames = num_frames;
+    pool->policy = policy;
+    pool->window = window;
+    pool->head = -1;
+    pool->tail = -1;
+    pool->hand = 0;
+
+    // the free list is a stack, so push the highest frame first
+    pool->num_free = 0;
+    for (int i = num_frames - 1; i >= 0; i--)
+    {
+        pool->frames[i].pid = -1;
+        pool->free_list[pool->num_free++] = i;
+    }
+    return 0;
+}
+
+void frames_free(struct FramePool *pool)
+{
+    free(pool->frames);
+    free(pool->free_list);
+    pool->frames = NULL;
+    pool->free_list = NULL;
+}
+
+int frames_save(struct FramePool *pool, FILE *file)
+{
+    int header[6] = {pool->num_frames, pool->policy, pool->num_free, pool->head, pool->tail, pool->hand};
+    if (checkpoint_write(file, header, sizeof(header)) != 0 ||
+        checkpoint_write(file, pool->frames, pool->num_frames * sizeof(struct Frame)) != 0 ||
+        checkpoint_write(file, pool->free_list, pool->num_frames * sizeof(int)) != 0)
+    {
+        return -1;
+    }
+    return 0;
+}
+
+int frames_restore(struct FramePool *pool, FILE *file)
+{
+    int header[6];
+    if (checkpoint_read(file, header, sizeof(header)) != 0 ||
+        header[0] != pool->num_frames || header[1] != (int)pool->policy ||
+        checkpoint_read(file, pool->frames, pool->num_frames * sizeof(struct Frame)) != 0 ||
+        checkpoint_read(file, pool->free_list, pool->num_frames * sizeof(int)) != 0)
+    {
+        return -1;
+    }
+    pool->num_free = header[2];
+    pool->head = header[3];
+    pool->tail = header[4];
+    pool->hand = header[5];
+    return 0;
+}
+
+static void unlink_frame(struct FramePool *pool, int i)
+{
+    struct Frame *f = &pool->frames[i];
+    if (f->prev != -1)
+    {
+        pool->frames[f->prev].next = f->next;
+    }
+    else
+    {
+        pool->head = f->next;
+    }
+    if (f->next != -1)
+    {
+        pool->frames[f->next].prev = f->prev;
+    }
+    else
+    {
+        pool->tail = f->prev;
+    }
+}
+
+static void push_frame(struct FramePool *pool, int i)
+{
+    struct Frame *f = &pool->frames[i];
+    f->prev = pool->tail;
+    f->next = -1;
+    if (pool->tail != -1)
+    {
+        pool->frames[pool->tail].next = i;
+    }
+    else
+    {
+        pool->head = i;
+    }
+    pool->tail = i;
+}
+
+// Second chance: clear reference bits until an unreferenced page comes round
+static int clock_victim(struct FramePool *pool)
+{
+    while (pool->frames[pool->hand].referenced)
+    {
+        pool->frames[pool->hand].referenced = FALSE;
+        pool->hand = (pool->hand + 1) % pool->num_frames;
+    }
+    return pool->hand;
+}
+
+// WSClock: a referenced page is in the working set as of now; an unreferenced
+// page whose last use is older than the window has left it. If every page is
+// in its working set, fall back to the least recently used one seen.
+static int ws_victim(struct FramePool *pool, uint32_t now)
+{
+    int oldest = -1;
+    for (int step = 0; step < 2 * pool->num_frames; step++)
+    {
+        int i = pool->hand;
+        struct Frame *f = &pool->frames[i];
+        pool->hand = (pool->hand + 1) % pool->num_frames;
+        if (f->referenced)
+        {
+            f->referenced = FALSE;
+            f->last_use = now;
+            continue;
+        }
+        if (now - f->last_use > pool->window)
+        {
+            return i;
+        }
+        if (oldest == -1 || f->last_use < pool->frames[oldest].last_use)
+        {
+            oldest = i;
+        }
+    }
+    return oldest;
+}
+
+int frames_alloc(struct FramePool *pool, int pid, int vpn, uint32_t now, struct Frame *victim)
+{
+    int i;
+
+    victim->pid = -1;
+    if (pool->num_free > 0)
+    {
+        i = pool->free_list[--pool->num_free];
+    }
+    else
+    {
+        switch (pool->policy)
+        {
+        case FRAME_CLOCK:
+            i = clock_victim(pool);
+            break;
+        case FRAME_WS:
+            i = ws_victim(pool, now);
+            break;
+        default:
+            i = pool->head;
+            break;
+        }
+        *victim = pool->frames[i];
+        unlink_frame(pool, i);
+
+        // the hand resumes after the replaced page
+        pool->hand = (i + 1) % pool->num_frames;
+    }
+
+    struct Frame *f = &pool->frames[i];
+    f->pid = pid;
+    f->vpn = vpn;
+    f->referenced = TRUE;
+    f->last_use = now;
+    push_frame(pool, i);
+    return i;
+}
+
+void frames_touch(struct FramePool *pool, int frame, uint32_t now)
+{
+    struct Frame *f = &pool->frames[frame];
+    f->referenced = TRUE;
+    if (pool->policy == FRAME_LRU)
+    {
+        f->last_use = now;
+        unlink_frame(pool, frame);
+        push_frame(pool, frame);
+    }
+}
+
+void frames_release(struct FramePool *pool, int frame)
+{
+    unlink_frame(pool, frame);
+    pool->frames[frame].pid = -1;
+    pool->free_list[pool->num_free++] = frame;
+}
@@ -0,0 +1,66 @@
+#ifndef __frames_h__
+#define __frames_h__
+
+#include <stdint.h>
+#include <stdio.h>
+
+// Page replacement policies of the demand-paging frame pool
+enum FramePolicy
+{
+    FRAME_LRU,   // evict the least recently referenced page
+    FRAME_CLOCK, // second chance on a reference bit
+    FRAME_WS,    // WSClock: evict a page outside the working-set window
+    NUM_FRAME_POLICIES,
+};
+
+// A physical frame and the page held in it. pid is -1 while the frame is free.
+struct Frame
+{
+    int pid;
+    int vpn;
+    int referenced;
+    uint32_t last_use;
+    int prev; // recency list, least recently referenced first
+    int next;
+};
+
+// A bounded pool of physical frames. Free frames are handed out lowest
+// first; once none is left, the policy picks a resident page to evict.
+struct FramePool
+{
+    int num_frames;
+    enum FramePolicy policy;
+    uint32_t window; // working-set window, in instructions
+    struct Frame *frames;
+    int *free_list;
+    int num_free;
+    int head;
+    int tail;
+    int hand;
+};
+
+// Parse a policy name (LRU, CLOCK or WS). Return 0 on success, -1 otherwise.
+int frames_parse_policy(const char *name, enum FramePolicy *policy);
+
+// Return 0 on success, -1 if allocation fails.
+int frames_init(struct FramePool *pool, int num_frames, enum FramePolicy policy, uint32_t window);
+void frames_free(struct FramePool *pool);
+
+// Write the frames and replacement state to a checkpoint, or read them back
+// into a pool initialized with the same size and policy.
+// Return 0 on success, -1 on an I/O error or a mismatched checkpoint.
+int frames_save(struct FramePool *pool, FILE *file);
+int frames_restore(struct FramePool *pool, FILE *file);
+
+// Take a frame for (pid, vpn) at instruction now. Return its number and set
+// *victim to the frame's evicted previous page, or victim->pid to -1 if the
+// frame was free.
+int frames_alloc(struct FramePool *pool, int pid, int vpn, uint32_t now, struct Frame *victim);
+
+// Record a reference to the page in frame
+void frames_touch(struct FramePool *pool, int frame, uint32_t now);
+
+// Return a frame to the free list
+void frames_release(struct FramePool *pool, int frame);
+
+#endif
@@ -3,62 +3,116 @@
 #include <string.h>
 #include <sys/types.h>
 #include <stdint.h>
+#include <limits.h>
+#include <stdarg.h>
+#include <getopt.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "tlb.h"
+#include "sweep.h"
+#include "analyze.h"
+#include "asid.h"
+#include "cost.h"
+#include "frames.h"
+#include "writer.h"
+#include "checkpoint.h"
+#include "trace.h"
 
 #define TRUE 1
 #define FALSE 0
 
-int memory_initialized = FALSE;
-
-int current_process = 0; // keep track of current process
-
-int registers[2] = {0}; // keep track of current registers r1 and r2
-
-uint32_t timestamp = 0; // global timestamp variable
-
 struct ProcessState
 {
     int r1;
     int r2;
 };
 
-struct ProcessState process_states[4];
+// Page table entry structure, packed into one word
+struct PageTableEntry
+{
+    uint32_t valid : 1; // Indicates if the entry is valid
+    uint32_t pfn : 31;  // Page Frame Number
+};
 
-// TLB entry structure
-struct TLBEntry
+// Per-process event counters
+struct Counters
 {
-    int valid;          // Indicates if the entry is valid
-    int process_id;     // Process ID associated with the entry (0 to 4)
-    int vpn;            // Virtual Page Number
-    int pfn;            // Page Frame Number
-    uint32_t timestamp; // timestampt for fifo and lru strategies
+    uint64_t instructions;
+    uint64_t tlb_hits;
+    uint64_t tlb_misses;
+    uint64_t tlb_evictions;
+    uint64_t page_faults;
+    uint64_t page_evictions;
+    uint64_t memory_accesses; // references that translated and reached memory
+    uint64_t tlb_flushes;     // times the process lost its ASID
+    uint64_t flushed_entries; // TLB entries dropped with it
 };
 
-// Page table entry structure
-struct PageTableEntry
+// The state of one simulated machine running one trace. The options below
+// are shared by every simulation and are only written while parsing the
+// command line, so simulations can run on separate threads.
+struct Simulation
 {
-    int valid; // Indicates if the entry is valid
-    int pfn;   // Page Frame Number
+    int memory_initialized;
+    int current_process;     // keep track of current process
+    int registers[2];        // keep track of current registers r1 and r2
+    uint32_t timestamp;      // instruction timestamp for the TLB strategies
+    struct ProcessState process_states[4];
+
+    // array of page tables for each process
+    struct PageTableEntry **page_tables;
+
+    // physical memory
+    uint32_t *physical_memory;
+
+    struct TLB tlb;
+
+    // ASIDs handed out on context switches; a recycled ASID flushes its old owner's entries
+    struct ASIDPool asids;
+
+    // demand paging frame pool and the contents of evicted pages, per process and VPN
+    struct FramePool frame_pool;
+    uint32_t **swapped_pages;
+    int num_swap_slots;
+
+    // geometry set by define
+    int off;        // offset bits
+    int num_frames; // words of physical memory
+    int num_pages;  // pages per address space
+
+    struct Writer writer;
+    struct Counters counters[4];
 };
 
-// array of page tables for each process
-struct PageTableEntry **page_tables = NULL;
+// Whether translations enter the TLB on a miss (hardware refill) rather than on map
+int fill_on_miss = FALSE;
+
+// Demand paging: loads and stores fault pages into a bounded pool of frames,
+// and map takes its frame from the pool instead of the trace
+int demand_paging = FALSE;
+int demand_frames = 0; // pool size, 0 for every frame of physical memory
+enum FramePolicy frame_policy = FRAME_LRU;
+uint32_t ws_window = 100;
 
-// physical memory
-uint32_t *physical_memory = NULL;
+// Latencies used to turn the counters into cycles
+struct CostModel cost;
 
-// TLB
-struct TLBEntry tlb[8];
+// Summary mode: only errors and the final counters are written
+int summary_mode = FALSE;
 
-// Output file
-FILE *output_file;
+// TLB replacement strategy (FIFO, LRU, CLOCK, RANDOM, LFU or ARC)
+enum TLBPolicy strategy;
 
-// TLB replacement strategy (FIFO or LRU)
-char *strategy;
+// Write the machine state to checkpoint_path once instruction checkpoint_at
+// has executed
+const char *checkpoint_path = NULL;
+uint32_t checkpoint_at = 0;
 
 char **tokenize_input(char *input)
 {
     char **tokens = NULL;
-    char *token = strtok(input, " ");
+    char *save;
+    char *token = strtok_r(input, " ", &save);
     int num_tokens = 0;
 
     while (token != NULL)
@@ -67,7 +121,7 @@ char **tokenize_input(char *input)
         tokens = realloc(tokens, num_tokens * sizeof(char *));
         tokens[num_tokens - 1] = malloc(strlen(token) + 1);
         strcpy(tokens[num_tokens - 1], token);
-        token = strtok(NULL, " ");
+        token = strtok_r(NULL, " ", &save);
     }
 
     num_tokens++;
@@ -77,40 +131,325 @@ char **tokenize_input(char *input)
     return tokens;
 }
 
-int main(int argc, char *argv[])
+// Log the outcome of an instruction
+void log_event(struct Simulation *sim, const char *format, ...)
 {
-    const char usage[] = "Usage: memsym.out <strategy> <input trace> <output trace>\n";
-    char *input_trace;
-    char *output_trace;
-    char buffer[1024];
+    if (summary_mode)
+    {
+        return;
+    }
+    va_list args;
+    va_start(args, format);
+    writer_vprintf(&sim->writer, format, args);
+    va_end(args);
+}
 
-    // Initialize variables
-    int num_frames;
-    int num_pages;
-    int off;
+// Log an error; errors are written in summary mode too
+void log_error(struct Simulation *sim, const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    writer_vprintf(&sim->writer, format, args);
+    va_end(args);
+}
 
-    // Parse command line arguments
-    if (argc != 4)
+static void write_counters(struct Writer *w, const char *label, struct Counters *c)
+{
+    uint64_t references = c->tlb_hits + c->tlb_misses;
+    uint64_t cycles = cost_cycles(&cost, references, c->tlb_misses, c->memory_accesses);
+    char amat[32];
+
+    // the writer does not format floating point
+    snprintf(amat, sizeof(amat), "%.2f", references ? (double)cycles / references : 0.0);
+    writer_printf(w, "%s. Instructions: %llu. TLB hits: %llu. TLB misses: %llu. TLB evictions: %llu. Page faults: %llu. TLB flushes: %llu. Flushed entries: %llu. Cycles: %llu. AMAT: %s",
+                  label, (unsigned long long)c->instructions, (unsigned long long)c->tlb_hits,
+                  (unsigned long long)c->tlb_misses, (unsigned long long)c->tlb_evictions,
+                  (unsigned long long)c->page_faults, (unsigned long long)c->tlb_flushes,
+                  (unsigned long long)c->flushed_entries, (unsigned long long)cycles, amat);
+    if (demand_paging)
     {
-        printf("%s", usage);
-        return 1;
+        char fault_rate[32];
+        snprintf(fault_rate, sizeof(fault_rate), "%.6f", references ? (double)c->page_faults / references : 0.0);
+        writer_printf(w, ". Page evictions: %llu. Fault rate: %s", (unsigned long long)c->page_evictions, fault_rate);
     }
-    strategy = argv[1];
-    input_trace = argv[2];
-    output_trace = argv[3];
+    writer_printf(w, "\n");
+}
 
-    // Open input and output files
-    FILE *input_file = fopen(input_trace, "r");
-    output_file = fopen(output_trace, "w");
+static void add_counters(struct Counters *total, const struct Counters *c)
+{
+    total->instructions += c->instructions;
+    total->tlb_hits += c->tlb_hits;
+    total->tlb_misses += c->tlb_misses;
+    total->tlb_evictions += c->tlb_evictions;
+    total->page_faults += c->page_faults;
+    total->page_evictions += c->page_evictions;
+    total->memory_accesses += c->memory_accesses;
+    total->tlb_flushes += c->tlb_flushes;
+    total->flushed_entries += c->flushed_entries;
+}
+
+// Write the counters of every process and their totals
+void write_summary(struct Simulation *sim)
+{
+    struct Counters total = {0};
+    char label[32];
+
+    for (int pid = 0; pid < 4; pid++)
+    {
+        snprintf(label, sizeof(label), "Summary for PID %d", pid);
+        write_counters(&sim->writer, label, &sim->counters[pid]);
+        add_counters(&total, &sim->counters[pid]);
+    }
+    write_counters(&sim->writer, "Summary for all processes", &total);
+}
+
+// Demand paging: give page vpn of the current process a frame from the pool,
+// evicting another page if none is free, and restore its contents if it was
+// evicted before. Return the frame number, or -1 if the victim page cannot
+// be saved.
+int page_in(struct Simulation *sim, int vpn)
+{
+    int page_size = 1 << sim->off;
+    struct Frame victim;
+    int pfn = frames_alloc(&sim->frame_pool, sim->current_process, vpn, sim->timestamp, &victim);
+    uint32_t *frame = &sim->physical_memory[pfn << sim->off];
+
+    if (victim.pid != -1)
+    {
+        uint32_t **saved = &sim->swapped_pages[victim.pid * sim->num_pages + victim.vpn];
+        *saved = malloc(page_size * sizeof(uint32_t));
+        if (*saved == NULL)
+        {
+            return -1;
+        }
+        memcpy(*saved, frame, page_size * sizeof(uint32_t));
+        sim->page_tables[victim.pid][victim.vpn].valid = FALSE;
+        tlb_invalidate(&sim->tlb, victim.pid, victim.vpn);
+        sim->counters[victim.pid].page_evictions++;
+        log_event(sim, "Current PID: %d. Evicted VPN %d of process %d from physical frame %d\n", sim->current_process, victim.vpn, victim.pid, pfn);
+    }
+
+    // a page that was never evicted starts out zeroed
+    uint32_t **saved = &sim->swapped_pages[sim->current_process * sim->num_pages + vpn];
+    if (*saved != NULL)
+    {
+        memcpy(frame, *saved, page_size * sizeof(uint32_t));
+        free(*saved);
+        *saved = NULL;
+    }
+    else
+    {
+        memset(frame, 0, page_size * sizeof(uint32_t));
+    }
+
+    sim->page_tables[sim->current_process][vpn].valid = TRUE;
+    sim->page_tables[sim->current_process][vpn].pfn = pfn;
+    return pfn;
+}
+
+// Demand paging: a load or store of the current process touched page vpn,
+// which is not resident. Page it in, and install the translation in the TLB
+// as map would. Return 0, or -1 after logging an error.
+int page_fault(struct Simulation *sim, int vpn)
+{
+    sim->counters[sim->current_process].page_faults++;
+    int pfn = page_in(sim, vpn);
+    if (pfn == -1)
+    {
+        log_error(sim, "Current PID: %d. Error: out of memory\n", sim->current_process);
+        return -1;
+    }
+    log_event(sim, "Current PID: %d. Page fault for VPN %d. Loaded into physical frame %d\n", sim->current_process, vpn, pfn);
+
+    if (!fill_on_miss)
+    {
+        int evicted;
+        tlb_map(&sim->tlb, sim->current_process, vpn, pfn, sim->timestamp, &evicted);
+        sim->counters[sim->current_process].tlb_evictions += evicted;
+    }
+    return 0;
+}
+
+// Options a checkpoint must be resumed with, as they shape the saved state
+static void checkpoint_options(struct Simulation *sim, int *options)
+{
+    options[0] = strategy;
+    options[1] = fill_on_miss;
+    options[2] = demand_paging;
+    options[3] = demand_frames;
+    options[4] = frame_policy;
+    options[5] = ws_window;
+    options[6] = sim->asids.size;
+}
+
+// Write the machine state and the position in the trace to path, so a later
+// run can resume from the next instruction. Return 0 on success, -1 otherwise.
+int checkpoint_save(struct Simulation *sim, FILE *input_file, const char *path)
+{
+    FILE *file = fopen(path, "wb");
+    if (file == NULL)
+    {
+        return -1;
+    }
+
+    int version = CHECKPOINT_VERSION;
+    int options[7];
+    long position = ftell(input_file);
+    int failed = FALSE;
+
+    checkpoint_options(sim, options);
+    failed |= checkpoint_write(file, CHECKPOINT_MAGIC, 8);
+    failed |= checkpoint_write(file, &version, sizeof(version));
+    failed |= checkpoint_write(file, options, sizeof(options));
+    failed |= checkpoint_write(file, &position, sizeof(position));
+    failed |= checkpoint_write(file, &sim->memory_initialized, sizeof(sim->memory_initialized));
+    failed |= checkpoint_write(file, &sim->current_process, sizeof(sim->current_process));
+    failed |= checkpoint_write(file, sim->registers, sizeof(sim->registers));
+    failed |= checkpoint_write(file, &sim->timestamp, sizeof(sim->timestamp));
+    failed |= checkpoint_write(file, sim->process_states, sizeof(sim->process_states));
+    failed |= checkpoint_write(file, &sim->asids, sizeof(sim->asids));
+    failed |= checkpoint_write(file, sim->counters, sizeof(sim->counters));
+    failed |= checkpoint_write(file, &sim->off, sizeof(sim->off));
+    failed |= checkpoint_write(file, &sim->num_frames, sizeof(sim->num_frames));
+    failed |= checkpoint_write(file, &sim->num_pages, sizeof(sim->num_pages));
+
+    if (sim->memory_initialized)
+    {
+        for (int pid = 0; pid < 4; pid++)
+        {
+            failed |= checkpoint_write(file, sim->page_tables[pid], sim->num_pages * sizeof(struct PageTableEntry));
+        }
+        failed |= checkpoint_write(file, sim->physical_memory, sim->num_frames * sizeof(uint32_t));
+    }
+    failed |= tlb_save(&sim->tlb, file);
+
+    // the frame pool, then each evicted page behind a presence flag
+    if (sim->memory_initialized && demand_paging)
+    {
+        failed |= checkpoint_write(file, &sim->frame_pool.num_frames, sizeof(int));
+        failed |= frames_save(&sim->frame_pool, file);
+        for (int i = 0; i < sim->num_swap_slots; i++)
+        {
+            char present = sim->swapped_pages[i] != NULL;
+            failed |= checkpoint_write(file, &present, 1);
+            if (present)
+            {
+                failed |= checkpoint_write(file, sim->swapped_pages[i], (1 << sim->off) * sizeof(uint32_t));
+            }
+        }
+    }
+
+    failed |= fclose(file) != 0;
+    return failed ? -1 : 0;
+}
+
+// Load a checkpoint written by checkpoint_save into a freshly initialized
+// simulation, and seek input_file to the instruction after it. The TLB
+// geometry and the options that shape the state must match the saved run.
+// Return 0 on success, -1 otherwise.
+int checkpoint_restore(struct Simulation *sim, FILE *input_file, const char *path)
+{
+    FILE *file = fopen(path, "rb");
+    if (file == NULL)
+    {
+        return -1;
+    }
+
+    char magic[8];
+    int version;
+    int options[7];
+    int saved_options[7];
+    long position;
+    int failed = FALSE;
+
+    checkpoint_options(sim, options);
+    failed |= checkpoint_read(file, magic, sizeof(magic));
+    failed |= checkpoint_read(file, &version, sizeof(version));
+    failed |= checkpoint_read(file, saved_options, sizeof(saved_options));
+    if (failed || memcmp(magic, CHECKPOINT_MAGIC, 8) != 0 || version != CHECKPOINT_VERSION ||
+        memcmp(options, saved_options, sizeof(options)) != 0)
+    {
+        fclose(file);
+        return -1;
+    }
+
+    failed |= checkpoint_read(file, &position, sizeof(position));
+    failed |= checkpoint_read(file, &sim->memory_initialized, sizeof(sim->memory_initialized));
+    failed |= checkpoint_read(file, &sim->current_process, sizeof(sim->current_process));
+    failed |= checkpoint_read(file, sim->registers, sizeof(sim->registers));
+    failed |= checkpoint_read(file, &sim->timestamp, sizeof(sim->timestamp));
+    failed |= checkpoint_read(file, sim->process_states, sizeof(sim->process_states));
+    failed |= checkpoint_read(file, &sim->asids, sizeof(sim->asids));
+    failed |= checkpoint_read(file, sim->counters, sizeof(sim->counters));
+    failed |= checkpoint_read(file, &sim->off, sizeof(sim->off));
+    failed |= checkpoint_read(file, &sim->num_frames, sizeof(sim->num_frames));
+    failed |= checkpoint_read(file, &sim->num_pages, sizeof(sim->num_pages));
+
+    if (!failed && sim->memory_initialized)
+    {
+        sim->page_tables = calloc(4, sizeof(struct PageTableEntry *));
+        sim->physical_memory = malloc(sim->num_frames * sizeof(uint32_t));
+        failed |= sim->page_tables == NULL || sim->physical_memory == NULL;
+        for (int pid = 0; !failed && pid < 4; pid++)
+        {
+            sim->page_tables[pid] = malloc(sim->num_pages * sizeof(struct PageTableEntry));
+            failed |= sim->page_tables[pid] == NULL ||
+                      checkpoint_read(file, sim->page_tables[pid], sim->num_pages * sizeof(struct PageTableEntry));
+        }
+        if (!failed)
+        {
+            failed |= checkpoint_read(file, sim->physical_memory, sim->num_frames * sizeof(uint32_t));
+        }
+    }
+    if (!failed)
+    {
+        failed |= tlb_restore(&sim->tlb, file);
+    }
+
+    if (!failed && sim->memory_initialized && demand_paging)
+    {
+        int pool_size;
+        failed |= checkpoint_read(file, &pool_size, sizeof(pool_size)) ||
+                  frames_init(&sim->frame_pool, pool_size, frame_policy, ws_window) ||
+                  frames_restore(&sim->frame_pool, file);
+        sim->num_swap_slots = 4 * sim->num_pages;
+        sim->swapped_pages = calloc(sim->num_swap_slots, sizeof(uint32_t *));
+        failed |= sim->swapped_pages == NULL;
+        for (int i = 0; !failed && i < sim->num_swap_slots; i++)
+        {
+            char present;
+            failed |= checkpoint_read(file, &present, 1);
+            if (!failed && present)
+            {
+                sim->swapped_pages[i] = malloc((1 << sim->off) * sizeof(uint32_t));
+                failed |= sim->swapped_pages[i] == NULL ||
+                          checkpoint_read(file, sim->swapped_pages[i], (1 << sim->off) * sizeof(uint32_t));
+            }
+        }
+    }
+
+    fclose(file);
+    if (failed || fseek(input_file, position, SEEK_SET) != 0)
+    {
+        return -1;
+    }
+    return 0;
+}
+
+// Execute the trace, logging each instruction. Return 0 once the end of the
+// trace is reached, or -1 after logging an error.
+int run_trace(struct Simulation *sim, FILE *input_file)
+{
+    char buffer[1024];
 
     while (!feof(input_file))
     {
         // Read input file line by line
-        char *rez = fgets(buffer, sizeof(buffer), input_file);
+        char *rez = trace_gets(buffer, sizeof(buffer), input_file);
         if (!rez)
         {
             fprintf(stderr, "Reached end of trace. Exiting...\n");
-            return -1;
+            return 0;
         }
         else
         {
@@ -119,7 +458,8 @@ int main(int argc, char *argv[])
             // Increment timestamp if line is an instruction (not starting with %)
             if (buffer[0] != '%')
             {
-                timestamp++;
+                sim->timestamp++;
+                sim->counters[sim->current_process].instructions++;
             }
         }
 
@@ -128,54 +468,64 @@ int main(int argc, char *argv[])
         if (strcmp(tokens[0], "define") == 0)
         {
             // check if defined is calles more than once
-            if (memory_initialized)
+            if (sim->memory_initialized)
             {
-                fprintf(output_file, "Current PID: %d. Error: multiple calls to define in the same trace\n", current_process);
+                log_error(sim, "Current PID: %d. Error: multiple calls to define in the same trace\n", sim->current_process);
                 return -1;
             }
 
-            off = atoi(tokens[1]);
+            sim->off = atoi(tokens[1]);
             int pfn = atoi(tokens[2]);
             int vpn_bits = atoi(tokens[3]);
 
-            num_frames = 1 << (off + pfn);
-            num_pages = 1 << vpn_bits;
+            sim->num_frames = 1 << (sim->off + pfn);
+            sim->num_pages = 1 << vpn_bits;
 
             // initialize physical memory
-            physical_memory = malloc(num_frames * sizeof(uint32_t));
-            memset(physical_memory, 0, num_frames * sizeof(uint32_t));
+            sim->physical_memory = malloc(sim->num_frames * sizeof(uint32_t));
+            memset(sim->physical_memory, 0, sim->num_frames * sizeof(uint32_t));
 
-            // initialize array of 4 page tables
-            page_tables = malloc(4 * sizeof(struct PageTableEntry *));
-            for (int i = 0; i < 4; i++)
+            if (demand_paging)
             {
-                page_tables[i] = malloc(num_pages * sizeof(struct PageTableEntry));
+                int pool_size = demand_frames ? demand_frames : 1 << pfn;
+                if (pool_size > 1 << pfn)
+                {
+                    log_error(sim, "Current PID: %d. Error: %d frames requested but physical memory holds %d\n", sim->current_process, pool_size, 1 << pfn);
+                    return -1;
+                }
+                sim->num_swap_slots = 4 * sim->num_pages;
+                sim->swapped_pages = calloc(sim->num_swap_slots, sizeof(uint32_t *));
+                if (sim->swapped_pages == NULL || frames_init(&sim->frame_pool, pool_size, frame_policy, ws_window) != 0)
+                {
+                    log_error(sim, "Current PID: %d. Error: out of memory\n", sim->current_process);
+                    return -1;
+                }
             }
 
-            // initialize TLB entries as invalid
-            for (int i = 0; i < 8; i++)
+            // initialize array of 4 page tables
+            sim->page_tables = malloc(4 * sizeof(struct PageTableEntry *));
+            for (int i = 0; i < 4; i++)
             {
-                tlb[i].valid = FALSE;
-                tlb[i].process_id = -1; // Initialize with an invalid process ID
+                sim->page_tables[i] = malloc(sim->num_pages * sizeof(struct PageTableEntry));
             }
 
             // initialize page table entries as invalid for all processes
             for (int pid = 0; pid < 4; pid++)
             {
-                for (int vpn = 0; vpn < num_pages; vpn++)
+                for (int vpn = 0; vpn < sim->num_pages; vpn++)
                 {
-                    page_tables[pid][vpn].valid = FALSE;
+                    sim->page_tables[pid][vpn].valid = FALSE;
                 }
             }
 
             // memory has been initialized
-            memory_initialized = TRUE;
+            sim->memory_initialized = TRUE;
 
-            fprintf(output_file, "Current PID: %d. Memory instantiation complete. OFF bits: %d. PFN bits: %d. VPN bits: %d\n", current_process, off, pfn, vpn_bits);
+            log_event(sim, "Current PID: %d. Memory instantiation complete. OFF bits: %d. PFN bits: %d. VPN bits: %d\n", sim->current_process, sim->off, pfn, vpn_bits);
         }
         else if (tokens[0] == NULL)
         {
-            fprintf(output_file, "\n");
+            log_event(sim, "\n");
         }
         else if (strcmp(tokens[0], "ctxswitch") == 0)
         {
@@ -184,36 +534,46 @@ int main(int argc, char *argv[])
             // raise error if context swicth to invalid process
             if (new_pid < 0 || new_pid > 3)
             {
-                fprintf(output_file, "Current PID: %d. Invalid context switch to process %d\n", current_process, new_pid);
+                log_error(sim, "Current PID: %d. Invalid context switch to process %d\n", sim->current_process, new_pid);
                 return -1;
             }
 
             // save the current state of registers for the current process
-            process_states[current_process].r1 = registers[0];
-            process_states[current_process].r2 = registers[1];
+            sim->process_states[sim->current_process].r1 = sim->registers[0];
+            sim->process_states[sim->current_process].r2 = sim->registers[1];
 
             // change current process
-            current_process = new_pid;
+            sim->current_process = new_pid;
 
             // restore registers' values from the saved state if available
-            registers[0] = process_states[current_process].r1;
-            registers[1] = process_states[current_process].r2;
+            sim->registers[0] = sim->process_states[sim->current_process].r1;
+            sim->registers[1] = sim->process_states[sim->current_process].r2;
 
-            fprintf(output_file, "Current PID: %d. Switched execution context to process: %d\n", current_process, new_pid);
+            log_event(sim, "Current PID: %d. Switched execution context to process: %d\n", sim->current_process, new_pid);
+
+            // the incoming process may take over the ASID of another one
+            int victim = asid_switch(&sim->asids, new_pid, sim->timestamp);
+            if (victim != -1)
+            {
+                int flushed = tlb_flush(&sim->tlb, victim);
+                sim->counters[victim].tlb_flushes++;
+                sim->counters[victim].flushed_entries += flushed;
+                log_event(sim, "Current PID: %d. Flushed %d TLB entries of process %d\n", sim->current_process, flushed, victim);
+            }
         }
         else if (strcmp(tokens[0], "map") == 0)
         {
             // check if memory is not initialized yet and raise error
-            if (!memory_initialized)
+            if (!sim->memory_initialized)
             {
-                fprintf(output_file, "Current PID: %d. Error: Memory not initialized\n", current_process);
+                log_error(sim, "Current PID: %d. Error: Memory not initialized\n", sim->current_process);
                 return -1;
             }
 
             // check if the current process is valid (0 to 3)
-            if (current_process < 0 || current_process > 3)
+            if (sim->current_process < 0 || sim->current_process > 3)
             {
-                fprintf(output_file, "Current PID: %d. Error: Invalid current process\n", current_process);
+                log_error(sim, "Current PID: %d. Error: Invalid current process\n", sim->current_process);
                 return -1;
             }
 
@@ -222,109 +582,69 @@ int main(int argc, char *argv[])
             int pfn = atoi(tokens[2]);
 
             // check if VPN is within the valid range
-            if (vpn < 0 || vpn >= num_pages)
+            if (vpn < 0 || vpn >= sim->num_pages)
             {
-                fprintf(output_file, "Current PID: %d. Error: Invalid VPN %d\n", current_process, vpn);
+                log_error(sim, "Current PID: %d. Error: Invalid VPN %d\n", sim->current_process, vpn);
                 return -1;
             }
 
-            // search for an existing TLB entry for the current process and VPN
-            int tlb_entry_index = -1;
-            for (int i = 0; i < 8; i++)
+            // under demand paging the frame comes from the pool, not the trace
+            if (demand_paging)
             {
-                if (tlb[i].valid && tlb[i].process_id == current_process && tlb[i].vpn == vpn)
+                pfn = sim->page_tables[sim->current_process][vpn].valid ? sim->page_tables[sim->current_process][vpn].pfn : page_in(sim, vpn);
+                if (pfn == -1)
                 {
-                    tlb_entry_index = i;
-                    break;
+                    log_error(sim, "Current PID: %d. Error: out of memory\n", sim->current_process);
+                    return -1;
                 }
             }
 
-            // if an existing entry is found, update it
-            // otherwise, find an empty entry
-            if (tlb_entry_index != -1)
+            // install the translation in the TLB, or only refresh an existing
+            // entry when the TLB is filled on misses
+            if (!fill_on_miss)
             {
-                tlb[tlb_entry_index].pfn = pfn;
-                if (strcmp(strategy, "FIFO") == 0)
-                {
-                    tlb[tlb_entry_index].timestamp = timestamp;
-                }
+                int evicted;
+                tlb_map(&sim->tlb, sim->current_process, vpn, pfn, sim->timestamp, &evicted);
+                sim->counters[sim->current_process].tlb_evictions += evicted;
             }
             else
             {
-                // find an empty TLB entry
-                for (int i = 0; i < 8; i++)
-                {
-                    if (!tlb[i].valid)
-                    {
-                        tlb_entry_index = i;
-                        break;
-                    }
-                }
-
-                // if all entries are occupied, implemnt either FIFO or LRU
-                if (tlb_entry_index == -1)
+                int tlb_entry_index = tlb_find(&sim->tlb, sim->current_process, vpn);
+                if (tlb_entry_index != -1)
                 {
-                    if (strcmp(strategy, "FIFO") == 0)
-                    {
-                        // find TLB entry with the smallest timestamp.
-                        int oldest_index = 0;
-                        for (int i = 1; i < 8; i++)
-                        {
-                            if (tlb[i].timestamp < tlb[oldest_index].timestamp)
-                            {
-                                oldest_index = i;
-                            }
-                        }
-                        tlb_entry_index = oldest_index;
-                    }
-                    else if (strcmp(strategy, "LRU") == 0)
-                    {
-                        // find TLB entry with the smallest timestamp.
-                        int least_recent_index = 0;
-                        for (int i = 1; i < 8; i++)
-                        {
-                            if (tlb[i].timestamp < tlb[least_recent_index].timestamp)
-                            {
-                                least_recent_index = i;
-                            }
-                        }
-                        tlb_entry_index = least_recent_index;
-                    }
+                    sim->tlb.pfn[tlb_entry_index] = pfn;
                 }
-
-                // update TLB entry
-                tlb[tlb_entry_index].valid = TRUE;
-                tlb[tlb_entry_index].process_id = current_process;
-                tlb[tlb_entry_index].vpn = vpn;
-                tlb[tlb_entry_index].pfn = pfn;
-                tlb[tlb_entry_index].timestamp = timestamp;
             }
 
             // update page table entry for current process and VPN
-            page_tables[current_process][vpn].valid = TRUE;
-            page_tables[current_process][vpn].pfn = pfn;
+            sim->page_tables[sim->current_process][vpn].valid = TRUE;
+            sim->page_tables[sim->current_process][vpn].pfn = pfn;
 
-            fprintf(output_file, "Current PID: %d. Mapped virtual page number %d to physical frame number %d\n", current_process, tlb[tlb_entry_index].vpn, tlb[tlb_entry_index].pfn = pfn);
+            log_event(sim, "Current PID: %d. Mapped virtual page number %d to physical frame number %d\n", sim->current_process, vpn, pfn);
         }
         else if (strcmp(tokens[0], "unmap") == 0)
         {
             // parse VPN from tokens
             int vpn = atoi(tokens[1]);
 
-            // search for and invalidate the TLB entry for the current process and VPN
-            for (int i = 0; i < 8; i++)
+            // invalidate the TLB entry for the current process and VPN
+            tlb_invalidate(&sim->tlb, sim->current_process, vpn);
+
+            // under demand paging the page's frame, or its saved copy, is released
+            if (demand_paging && vpn >= 0 && vpn < sim->num_pages)
             {
-                if (tlb[i].valid && tlb[i].process_id == current_process && tlb[i].vpn == vpn)
+                if (sim->page_tables[sim->current_process][vpn].valid)
                 {
-                    tlb[i].valid = FALSE;
-                    break;
+                    frames_release(&sim->frame_pool, sim->page_tables[sim->current_process][vpn].pfn);
                 }
+                free(sim->swapped_pages[sim->current_process * sim->num_pages + vpn]);
+                sim->swapped_pages[sim->current_process * sim->num_pages + vpn] = NULL;
             }
 
             // invalidate the page table entry for the current process and VPN
-            page_tables[current_process][vpn].valid = FALSE;
+            sim->page_tables[sim->current_process][vpn].valid = FALSE;
 
-            fprintf(output_file, "Current PID: %d. Unmapped virtual page number %d\n", current_process, vpn);
+            log_event(sim, "Current PID: %d. Unmapped virtual page number %d\n", sim->current_process, vpn);
         }
         else if (strcmp(tokens[0], "store") == 0)
         {
@@ -341,35 +661,48 @@ int main(int argc, char *argv[])
             int dst_memory_location = -1;
 
             // determine the VPN based on the dst_virtual_address and VPN bits
-            int vpn = dst_virtual_address >> off;
+            int vpn = dst_virtual_address >> sim->off;
 
-            for (int i = 0; i < 8; i++)
+            // check if VPN is within the valid range
+            if (vpn < 0 || vpn >= sim->num_pages)
             {
-                if (tlb[i].valid && tlb[i].process_id == current_process && tlb[i].vpn == (dst_virtual_address >> off))
-                {
-                    // TLB hit
-                    dst_memory_location = (tlb[i].pfn << off) | (dst_virtual_address & ((1 << off) - 1));
-                    fprintf(output_file, "Current PID: %d. Translating. Lookup for VPN %d hit in TLB entry %d. PFN is %d\n", current_process, vpn, i, tlb[i].pfn);
-                    if (strcmp(strategy, "LRU") == 0)
-                    {
-                        tlb[i].timestamp = timestamp;
-                    }
-                    break;
-                }
+                log_error(sim, "Current PID: %d. Error: Invalid VPN %d\n", sim->current_process, vpn);
+                return -1;
+            }
+
+            int i = tlb_lookup(&sim->tlb, sim->current_process, vpn, sim->timestamp);
+            if (i != -1)
+            {
+                // TLB hit
+                sim->counters[sim->current_process].tlb_hits++;
+                dst_memory_location = (sim->tlb.pfn[i] << sim->off) | (dst_virtual_address & ((1 << sim->off) - 1));
+                log_event(sim, "Current PID: %d. Translating. Lookup for VPN %d hit in TLB entry %d. PFN is %d\n", sim->current_process, vpn, i, sim->tlb.pfn[i]);
             }
 
             if (dst_memory_location == -1)
             {
                 // TLB miss, perform page table lookup
-                if (page_tables[current_process][vpn].valid)
+                sim->counters[sim->current_process].tlb_misses++;
+                if (demand_paging && !sim->page_tables[sim->current_process][vpn].valid && page_fault(sim, vpn) != 0)
                 {
-                    dst_memory_location = (page_tables[current_process][vpn].pfn << off) | (dst_virtual_address & ((1 << off) - 1));
-                    fprintf(output_file, "Current PID: %d. Translating. Lookup for VPN %d miss in TLB. PFN is %d\n", current_process, vpn, page_tables[current_process][vpn].pfn);
+                    return -1;
+                }
+                if (sim->page_tables[sim->current_process][vpn].valid)
+                {
+                    dst_memory_location = (sim->page_tables[sim->current_process][vpn].pfn << sim->off) | (dst_virtual_address & ((1 << sim->off) - 1));
+                    log_event(sim, "Current PID: %d. Translating. Lookup for VPN %d miss in TLB. PFN is %d\n", sim->current_process, vpn, sim->page_tables[sim->current_process][vpn].pfn);
+                    if (fill_on_miss)
+                    {
+                        int evicted;
+                        tlb_insert(&sim->tlb, sim->current_process, vpn, sim->page_tables[sim->current_process][vpn].pfn, sim->timestamp, &evicted);
+                        sim->counters[sim->current_process].tlb_evictions += evicted;
+                    }
                 }
                 else
                 {
                     // handle page table miss
-                    fprintf(output_file, "Current PID: %d. Error: Page table miss for VPN %d\n", current_process, vpn);
+                    sim->counters[sim->current_process].page_faults++;
+                    log_error(sim, "Current PID: %d. Error: Page table miss for VPN %d\n", sim->current_process, vpn);
                     return -1;
                 }
             }
@@ -378,28 +711,33 @@ int main(int argc, char *argv[])
             if (src_operand[0] == '#')
             {
                 src_value = atoi(&src_operand[1]);
-                fprintf(output_file, "Current PID: %d. Stored immediate %d into location %d\n", current_process, src_value, dst_virtual_address);
+                log_event(sim, "Current PID: %d. Stored immediate %d into location %d\n", sim->current_process, src_value, dst_virtual_address);
             }
             else
             {
                 int src_register = atoi(&src_operand[1]);
 
                 // get the value from the source register
-                src_value = registers[src_register - 1];
+                src_value = sim->registers[src_register - 1];
 
-                fprintf(output_file, "Current PID: %d. Stored value of register %s (%d) into location %d\n", current_process, src_operand, src_value, dst_virtual_address);
+                log_event(sim, "Current PID: %d. Stored value of register %s (%d) into location %d\n", sim->current_process, src_operand, src_value, dst_virtual_address);
             }
 
             // check if the memory location is valid
-            if (dst_memory_location >= 0 && dst_memory_location < num_frames)
+            if (dst_memory_location >= 0 && dst_memory_location < sim->num_frames)
             {
                 // store the value into the memory location
-                physical_memory[dst_memory_location] = src_value;
+                sim->physical_memory[dst_memory_location] = src_value;
+                sim->counters[sim->current_process].memory_accesses++;
+                if (demand_paging)
+                {
+                    frames_touch(&sim->frame_pool, dst_memory_location >> sim->off, sim->timestamp);
+                }
             }
             else
             {
                 // handle invalid memory location
-                fprintf(output_file, "Current PID: %d. Error: invalid memory location %d\n", current_process, dst_memory_location);
+                log_error(sim, "Current PID: %d. Error: invalid memory location %d\n", sim->current_process, dst_memory_location);
                 return -1;
             }
         }
@@ -407,14 +745,14 @@ int main(int argc, char *argv[])
         {
             if (tokens[1] == NULL || tokens[2] == NULL)
             {
-                fprintf(output_file, "Current PID: %d. Error: Invalid load instruction format\n", current_process);
+                log_error(sim, "Current PID: %d. Error: Invalid load instruction format\n", sim->current_process);
                 return -1;
             }
 
             // check that memory is initialized
-            if (!memory_initialized)
+            if (!sim->memory_initialized)
             {
-                fprintf(output_file, "Current PID: %d. Error: attempt to execute instruction before define\n", current_process);
+                log_error(sim, "Current PID: %d. Error: attempt to execute instruction before define\n", sim->current_process);
                 return -1;
             }
 
@@ -433,7 +771,7 @@ int main(int argc, char *argv[])
             else
             {
                 // handle invalid register operand
-                fprintf(output_file, "Current PID: %d. Error: invalid register operand %s\n", current_process, dst_register);
+                log_error(sim, "Current PID: %d. Error: invalid register operand %s\n", sim->current_process, dst_register);
                 return -1;
             }
 
@@ -441,8 +779,8 @@ int main(int argc, char *argv[])
             {
                 // if operand is an immediate
                 int immediate_value = atoi(&src_operand[1]);
-                registers[reg] = immediate_value;
-                fprintf(output_file, "Current PID: %d. Loaded immediate %d into register %s\n", current_process, registers[reg], dst_register);
+                sim->registers[reg] = immediate_value;
+                log_event(sim, "Current PID: %d. Loaded immediate %d into register %s\n", sim->current_process, sim->registers[reg], dst_register);
             }
             else
             {
@@ -450,50 +788,68 @@ int main(int argc, char *argv[])
                 int src_virtual_address = atoi(src_operand);
                 int src_memory_location = -1;
 
-                int vpn = src_virtual_address >> off;
+                int vpn = src_virtual_address >> sim->off;
 
-                for (int i = 0; i < 8; i++)
+                // check if VPN is within the valid range
+                if (vpn < 0 || vpn >= sim->num_pages)
                 {
-                    if (tlb[i].valid && tlb[i].process_id == current_process && tlb[i].vpn == vpn)
-                    {
-                        // TLB hit
-                        src_memory_location = (tlb[i].pfn << off) | (src_virtual_address & ((1 << off) - 1));
-                        fprintf(output_file, "Current PID: %d. Translating. Lookup for VPN %d hit in TLB entry %d. PFN is %d\n", current_process, vpn, i, tlb[i].pfn);
-                        if (strcmp(strategy, "LRU") == 0)
-                        {
-                            tlb[i].timestamp = timestamp;
-                        }
-                        break;
-                    }
+                    log_error(sim, "Current PID: %d. Error: Invalid VPN %d\n", sim->current_process, vpn);
+                    return -1;
+                }
+
+                int i = tlb_lookup(&sim->tlb, sim->current_process, vpn, sim->timestamp);
+                if (i != -1)
+                {
+                    // TLB hit
+                    sim->counters[sim->current_process].tlb_hits++;
+                    src_memory_location = (sim->tlb.pfn[i] << sim->off) | (src_virtual_address & ((1 << sim->off) - 1));
+                    log_event(sim, "Current PID: %d. Translating. Lookup for VPN %d hit in TLB entry %d. PFN is %d\n", sim->current_process, vpn, i, sim->tlb.pfn[i]);
                 }
 
                 if (src_memory_location == -1)
                 {
                     // TLB miss, perform page table lookup
-                    if (page_tables[current_process][vpn].valid)
+                    sim->counters[sim->current_process].tlb_misses++;
+                    if (demand_paging && !sim->page_tables[sim->current_process][vpn].valid && page_fault(sim, vpn) != 0)
+                    {
+                        return -1;
+                    }
+                    if (sim->page_tables[sim->current_process][vpn].valid)
                     {
-                        src_memory_location = (page_tables[current_process][vpn].pfn << off) | (src_virtual_address & ((1 << off) - 1));
-                        fprintf(output_file, "Current PID: %d. Translating. Lookup for VPN %d miss in TLB. PFN is %d\n", current_process, vpn, page_tables[current_process][vpn].pfn);
+                        src_memory_location = (sim->page_tables[sim->current_process][vpn].pfn << sim->off) | (src_virtual_address & ((1 << sim->off) - 1));
+                        log_event(sim, "Current PID: %d. Translating. Lookup for VPN %d miss in TLB. PFN is %d\n", sim->current_process, vpn, sim->page_tables[sim->current_process][vpn].pfn);
+                        if (fill_on_miss)
+                        {
+                            int evicted;
+                            tlb_insert(&sim->tlb, sim->current_process, vpn, sim->page_tables[sim->current_process][vpn].pfn, sim->timestamp, &evicted);
+                            sim->counters[sim->current_process].tlb_evictions += evicted;
+                        }
                     }
                     else
                     {
                         // handle page table miss
-                        fprintf(output_file, "Current PID: %d. Translating. Lookup for VPN %d caused a TLB miss\n", current_process, vpn);
-                        fprintf(output_file, "Current PID: %d. Translating. Translation for VPN %d not found in page table\n", current_process, vpn);
+                        sim->counters[sim->current_process].page_faults++;
+                        log_error(sim, "Current PID: %d. Translating. Lookup for VPN %d caused a TLB miss\n", sim->current_process, vpn);
+                        log_error(sim, "Current PID: %d. Translating. Translation for VPN %d not found in page table\n", sim->current_process, vpn);
                         return -1;
                     }
                 }
 
-                if (src_memory_location >= 0 && src_memory_location < num_frames)
+                if (src_memory_location >= 0 && src_memory_location < sim->num_frames)
                 {
                     // load the value from the memory location into the destination register
-                    registers[reg] = physical_memory[src_memory_location];
-                    fprintf(output_file, "Current PID: %d. Loaded value of location %d (%d) into register %s\n", current_process, src_virtual_address, registers[reg], dst_register);
+                    sim->registers[reg] = sim->physical_memory[src_memory_location];
+                    sim->counters[sim->current_process].memory_accesses++;
+                    if (demand_paging)
+                    {
+                        frames_touch(&sim->frame_pool, src_memory_location >> sim->off, sim->timestamp);
+                    }
+                    log_event(sim, "Current PID: %d. Loaded value of location %d (%d) into register %s\n", sim->current_process, src_virtual_address, sim->registers[reg], dst_register);
                 }
                 else
                 {
                     // handle invalid memory location
-                    fprintf(output_file, "Current PID: %d. Error: invalid memory location %d\n", current_process, src_memory_location);
+                    log_error(sim, "Current PID: %d. Error: invalid memory location %d\n", sim->current_process, src_memory_location);
                     return -1;
                 }
             }
@@ -501,13 +857,13 @@ int main(int argc, char *argv[])
         else if (strcmp(tokens[0], "add") == 0)
         {
 
-            int result = registers[0] + registers[1];
+            int result = sim->registers[0] + sim->registers[1];
 
             // output the result
-            fprintf(output_file, "Current PID: %d. Added contents of registers r1 (%d) and r2 (%d). Result: %d\n", current_process, registers[0], registers[1], result);
+            log_event(sim, "Current PID: %d. Added contents of registers r1 (%d) and r2 (%d). Result: %d\n", sim->current_process, sim->registers[0], sim->registers[1], result);
 
             // store the result in register r1
-            registers[0] = result;
+            sim->registers[0] = result;
         }
         else if (strcmp(tokens[0], "rinspect") == 0)
         {
@@ -524,60 +880,565 @@ int main(int argc, char *argv[])
             }
             else
             {
-                fprintf(output_file, "Current PID: %d. Error: Invalid register %s\n", current_process, reg_to_inspect);
+                log_error(sim, "Current PID: %d. Error: Invalid register %s\n", sim->current_process, reg_to_inspect);
                 return -1;
             }
 
             // output the content of the register
-            fprintf(output_file, "Current PID: %d. Inspected register %s. Content: %u\n", current_process, reg_to_inspect, registers[reg]);
+            log_event(sim, "Current PID: %d. Inspected register %s. Content: %u\n", sim->current_process, reg_to_inspect, sim->registers[reg]);
         }
         else if (strcmp(tokens[0], "pinspect") == 0)
         {
             int vpn = atoi(tokens[1]);
 
-            int valid = page_tables[current_process][vpn].valid;
-            int pfn = valid ? page_tables[current_process][vpn].pfn : 0;
+            int valid = sim->page_tables[sim->current_process][vpn].valid;
+            int pfn = valid ? sim->page_tables[sim->current_process][vpn].pfn : 0;
 
-            fprintf(output_file, "Current PID: %d. Inspected page table entry %d. Physical frame number: %d. Valid: %d\n", current_process, vpn, pfn, valid);
+            log_event(sim, "Current PID: %d. Inspected page table entry %d. Physical frame number: %d. Valid: %d\n", sim->current_process, vpn, pfn, valid);
         }
         else if (strcmp(tokens[0], "linspect") == 0)
         {
             int pl = atoi(tokens[1]);
 
-            unsigned int value = physical_memory[pl];
-            fprintf(output_file, "Current PID: %d. Inspected physical location %d. Value: %u\n", current_process, pl, value);
+            unsigned int value = sim->physical_memory[pl];
+            log_event(sim, "Current PID: %d. Inspected physical location %d. Value: %u\n", sim->current_process, pl, value);
         }
         else if (strcmp(tokens[0], "tinspect") == 0)
         {
             int tlb_number = atoi(tokens[1]);
 
-            struct TLBEntry tlb_entry = tlb[tlb_number];
+            struct TLB *t = &sim->tlb;
 
-            fprintf(output_file, "Current PID: %d. Inspected TLB entry %d. VPN: %d. PFN: %d. Valid: %d. PID: %d. Timestamp: %d\n",
-                    current_process, tlb_number, tlb_entry.vpn, tlb_entry.pfn, tlb_entry.valid, tlb_entry.process_id, tlb_entry.timestamp);
+            log_event(sim, "Current PID: %d. Inspected TLB entry %d. VPN: %d. PFN: %d. Valid: %d. PID: %d. Timestamp: %d\n",
+                    sim->current_process, tlb_number, t->vpn[tlb_number], t->pfn[tlb_number], tlb_valid(t, tlb_number), t->process_id[tlb_number], t->timestamp[tlb_number]);
         }
 
         // deallocate tokens
         for (int i = 0; tokens[i] != NULL; i++)
             free(tokens[i]);
         free(tokens);
+
+        // comment lines do not advance the timestamp, so save on the instruction itself
+        if (checkpoint_path != NULL && buffer[0] != '%' && sim->timestamp == checkpoint_at &&
+            checkpoint_save(sim, input_file, checkpoint_path) != 0)
+        {
+            log_error(sim, "Current PID: %d. Error: cannot write checkpoint %s\n", sim->current_process, checkpoint_path);
+            return -1;
+        }
+    }
+
+
+    return 0;
+}
+
+// Set up a machine with an empty TLB whose log goes to output.
+// Return 0 on success, -1 if the TLB geometry is invalid or allocation fails.
+int simulation_init(struct Simulation *sim, FILE *output, int tlb_entries, int tlb_ways, int asid_pool)
+{
+    memset(sim, 0, sizeof(*sim));
+    if (tlb_init(&sim->tlb, tlb_entries, tlb_ways, strategy) != 0)
+    {
+        return -1;
+    }
+    asid_init(&sim->asids, asid_pool, sim->current_process);
+    if (writer_open(&sim->writer, output, WRITER_BUFFER_SIZE) != 0)
+    {
+        tlb_free(&sim->tlb);
+        return -1;
     }
+    return 0;
+}
+
+// Flush the log and release the machine. The output file is left open.
+void simulation_free(struct Simulation *sim)
+{
+    writer_close(&sim->writer);
 
     // Free each of the page table arrays
-    for (int i = 0; i < 4; i++)
+    for (int i = 0; sim->page_tables != NULL && i < 4; i++)
     {
-        free(page_tables[i]);
+        free(sim->page_tables[i]);
     }
 
     // Now free the array of pointers
-    free(page_tables);
+    free(sim->page_tables);
 
     // free physical memory
-    free(physical_memory);
+    free(sim->physical_memory);
+
+    // release the frame pool and the contents of evicted pages
+    for (int i = 0; sim->swapped_pages != NULL && i < sim->num_swap_slots; i++)
+    {
+        free(sim->swapped_pages[i]);
+    }
+    free(sim->swapped_pages);
+    frames_free(&sim->frame_pool);
+
+    tlb_free(&sim->tlb);
+}
+
+// One trace of a batch and its outcome
+struct BatchJob
+{
+    char *trace;
+    char *log; // errors and summary of the trace, as in summary mode
+    size_t log_size;
+    struct Counters counters[4];
+    int status;
+};
+
+// Traces shared by the worker threads, which take the next unclaimed one
+struct Batch
+{
+    struct BatchJob *jobs;
+    int num_jobs;
+    int next;
+    pthread_mutex_t lock;
+    int tlb_entries;
+    int tlb_ways;
+    int asid_pool;
+};
+
+static void run_job(struct Batch *batch, struct BatchJob *job)
+{
+    FILE *log = open_memstream(&job->log, &job->log_size);
+    if (log == NULL)
+    {
+        job->status = -1;
+        return;
+    }
+
+    struct Simulation sim;
+    FILE *input_file = fopen(job->trace, "r");
+    if (input_file == NULL)
+    {
+        fprintf(log, "Error: cannot open %s\n", job->trace);
+        job->status = -1;
+    }
+    else if (simulation_init(&sim, log, batch->tlb_entries, batch->tlb_ways, batch->asid_pool) != 0)
+    {
+        fprintf(log, "Error: cannot allocate the simulation\n");
+        job->status = -1;
+        fclose(input_file);
+    }
+    else
+    {
+        job->status = run_trace(&sim, input_file);
+        write_summary(&sim);
+        memcpy(job->counters, sim.counters, sizeof(job->counters));
+        simulation_free(&sim);
+        fclose(input_file);
+    }
+    fclose(log);
+}
+
+static void *batch_worker(void *arg)
+{
+    struct Batch *batch = arg;
+    while (TRUE)
+    {
+        pthread_mutex_lock(&batch->lock);
+        int i = batch->next++;
+        pthread_mutex_unlock(&batch->lock);
+        if (i >= batch->num_jobs)
+        {
+            return NULL;
+        }
+        run_job(batch, &batch->jobs[i]);
+    }
+}
+
+// Simulate every trace named in list, one path per line, on a pool of
+// threads. Write the summary of each trace, in list order, then the counters
+// summed over all traces to report. Return 0 if every trace ran to its end.
+int run_batch(FILE *list, FILE *report, int tlb_entries, int tlb_ways, int asid_pool, int num_threads)
+{
+    struct Batch batch = {NULL, 0, 0, PTHREAD_MUTEX_INITIALIZER, tlb_entries, tlb_ways, asid_pool};
+    char buffer[4096];
+    int capacity = 0;
+    int status = 0;
+
+    // validate the geometry once rather than in every job
+    struct TLB probe;
+    if (tlb_init(&probe, tlb_entries, tlb_ways, strategy) != 0)
+    {
+        fprintf(stderr, "Error: invalid TLB geometry %d entries, %d ways\n", tlb_entries, tlb_ways);
+        return -1;
+    }
+    tlb_free(&probe);
+
+    while (fgets(buffer, sizeof(buffer), list) != NULL)
+    {
+        buffer[strcspn(buffer, "\r\n")] = '\0';
+        if (buffer[0] == '\0')
+        {
+            continue;
+        }
+        if (batch.num_jobs == capacity)
+        {
+            capacity = capacity ? 2 * capacity : 64;
+            struct BatchJob *jobs = realloc(batch.jobs, capacity * sizeof(struct BatchJob));
+            if (jobs == NULL)
+            {
+                fprintf(stderr, "Error: out of memory\n");
+                status = -1;
+                break;
+            }
+            batch.jobs = jobs;
+        }
+        struct BatchJob *job = &batch.jobs[batch.num_jobs];
+        memset(job, 0, sizeof(*job));
+        job->trace = strdup(buffer);
+        batch.num_jobs++;
+    }
+
+    if (num_threads > batch.num_jobs)
+    {
+        num_threads = batch.num_jobs;
+    }
+    pthread_t *threads = malloc(num_threads * sizeof(pthread_t));
+    int started = 0;
+    while (status == 0 && threads != NULL && started < num_threads &&
+           pthread_create(&threads[started], NULL, batch_worker, &batch) == 0)
+    {
+        started++;
+    }
+    if (status == 0 && started == 0 && batch.num_jobs > 0)
+    {
+        // no worker could be started, run the batch on this thread
+        batch_worker(&batch);
+    }
+    for (int i = 0; i < started; i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+    free(threads);
+
+    struct Writer w;
+    struct Counters totals[4] = {0};
+    struct Counters total = {0};
+    int failed = 0;
+    char label[64];
+
+    if (status == 0 && writer_open(&w, report, WRITER_BUFFER_SIZE) == 0)
+    {
+        for (int i = 0; i < batch.num_jobs; i++)
+        {
+            struct BatchJob *job = &batch.jobs[i];
+            writer_printf(&w, "Trace %s\n", job->trace);
+            writer_printf(&w, "%s", job->log != NULL ? job->log : "Error: cannot allocate the log\n");
+            failed += job->status != 0;
+            for (int pid = 0; pid < 4; pid++)
+            {
+                add_counters(&totals[pid], &job->counters[pid]);
+            }
+        }
+        writer_printf(&w, "Batch of %d traces, %d stopped on an error\n", batch.num_jobs, failed);
+        for (int pid = 0; pid < 4; pid++)
+        {
+            snprintf(label, sizeof(label), "Summary for PID %d across traces", pid);
+            write_counters(&w, label, &totals[pid]);
+            add_counters(&total, &totals[pid]);
+        }
+        write_counters(&w, "Summary for all processes across traces", &total);
+        writer_close(&w);
+    }
+    else if (status == 0)
+    {
+        fprintf(stderr, "Error: out of memory\n");
+        status = -1;
+    }
+
+    for (int i = 0; i < batch.num_jobs; i++)
+    {
+        free(batch.jobs[i].trace);
+        free(batch.jobs[i].log);
+    }
+    free(batch.jobs);
+    pthread_mutex_destroy(&batch.lock);
+    return status == 0 && failed == 0 ? 0 : -1;
+}
+
+int main(int argc, char *argv[])
+{
+    const char usage[] = "Usage: memsym.out [options] <strategy> <input trace> <output trace>\n"
+                         "Strategies: FIFO, LRU, CLOCK, RANDOM, LFU, ARC\n"
+                         "Input traces may be text or compiled by tracegen.out\n"
+                         "  -t, --tlb-size=N   number of TLB entries (default 8)\n"
+                         "  -w, --ways=N       TLB associativity, 0 for fully associative (default 0)\n"
+                         "  -f, --fill=WHEN    translations enter the TLB on 'map' (default) or on a 'miss'\n"
+                         "  -s, --sweep        replay the trace against every combination of the comma-separated\n"
+                         "                     strategies, -t sizes and -w associativities; write a CSV table\n"
+                         "  -q, --summary      write only errors and per-process counters instead of the full log\n"
+                         "  -a, --asid=MODE    'tagged' TLB entries survive context switches (default), 'flush' the TLB\n"
+                         "                     on every switch, or N ASIDs recycled least recently scheduled first\n"
+                         "  -c, --cycles=H,W,M latencies of a TLB hit, a page walk level and a memory access,\n"
+                         "                     used for the cycle and AMAT figures of the summary and sweep (default " COST_DEFAULT_SPEC ")\n"
+                         "  -l, --levels=N     page table levels walked on a TLB miss (default 1)\n"
+                         "  -d, --demand=N     demand paging: loads and stores fault pages into a pool of N frames\n"
+                         "                     (0 for all of physical memory); map takes its frame from the pool\n"
+                         "  -r, --replace=P    page replacement under demand paging: LRU (default), CLOCK or WS\n"
+                         "  -W, --window=N     working-set window of WS, in instructions (default 100)\n"
+                         "  -b, --batch        the input is a list of trace files, one per line; simulate them in\n"
+                         "                     parallel and write each summary and their totals to the output\n"
+                         "  -j, --jobs=N       worker threads of a batch (default: one per online CPU)\n"
+                         "  -k, --checkpoint=N:FILE  save the machine state to FILE after instruction N\n"
+                         "  -R, --restore=FILE resume from a checkpoint with the same trace, strategy and options;\n"
+                         "                     segments of a trace can be simulated in parallel from checkpoints\n"
+                         "  -A, --analyze      characterize the page references of the trace instead of simulating it:\n"
+                         "                     working sets, LRU stack distances and hot pages as CSV tables\n"
+                         "  -n, --windows=LIST comma-separated working-set windows, in references (default " ANALYZE_DEFAULT_WINDOWS ")\n"
+                         "  -p, --hot-pages=N  number of most referenced pages listed by -A (default 10)\n";
+    const struct option long_options[] = {
+        {"tlb-size", required_argument, NULL, 't'},
+        {"ways", required_argument, NULL, 'w'},
+        {"fill", required_argument, NULL, 'f'},
+        {"sweep", no_argument, NULL, 's'},
+        {"summary", no_argument, NULL, 'q'},
+        {"asid", required_argument, NULL, 'a'},
+        {"cycles", required_argument, NULL, 'c'},
+        {"levels", required_argument, NULL, 'l'},
+        {"demand", required_argument, NULL, 'd'},
+        {"replace", required_argument, NULL, 'r'},
+        {"window", required_argument, NULL, 'W'},
+        {"batch", no_argument, NULL, 'b'},
+        {"jobs", required_argument, NULL, 'j'},
+        {"checkpoint", required_argument, NULL, 'k'},
+        {"restore", required_argument, NULL, 'R'},
+        {"analyze", no_argument, NULL, 'A'},
+        {"windows", required_argument, NULL, 'n'},
+        {"hot-pages", required_argument, NULL, 'p'},
+        {NULL, 0, NULL, 0}};
+    char *input_trace;
+    char *output_trace;
+    char *tlb_sizes = "8";
+    char *tlb_ways = "0";
+    int sweep_mode = FALSE;
+    int asid_pool = ASID_TAGGED;
+    int batch_mode = FALSE;
+    int jobs = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    char *restore_path = NULL;
+    int analyze_mode = FALSE;
+    struct AnalyzeConfig analysis = {ANALYZE_DEFAULT_WINDOWS, ANALYZE_DEFAULT_HOT_PAGES};
+    int opt;
+
+    cost_parse(COST_DEFAULT_SPEC, &cost);
+    cost.levels = COST_DEFAULT_LEVELS;
+
+    // Parse command line arguments
+    while ((opt = getopt_long(argc, argv, "t:w:f:sqa:c:l:d:r:W:bj:k:R:An:p:", long_options, NULL)) != -1)
+    {
+        switch (opt)
+        {
+        case 't':
+            tlb_sizes = optarg;
+            break;
+        case 'w':
+            tlb_ways = optarg;
+            break;
+        case 'f':
+            if (strcmp(optarg, "map") == 0)
+            {
+                fill_on_miss = FALSE;
+            }
+            else if (strcmp(optarg, "miss") == 0)
+            {
+                fill_on_miss = TRUE;
+            }
+            else
+            {
+                printf("%s", usage);
+                return 1;
+            }
+            break;
+        case 's':
+            sweep_mode = TRUE;
+            break;
+        case 'q':
+            summary_mode = TRUE;
+            break;
+        case 'a':
+            if (asid_parse(optarg, &asid_pool) != 0)
+            {
+                printf("%s", usage);
+                return 1;
+            }
+            break;
+        case 'c':
+            if (cost_parse(optarg, &cost) != 0)
+            {
+                printf("%s", usage);
+                return 1;
+            }
+            break;
+        case 'l':
+            cost.levels = atoi(optarg);
+            if (cost.levels < 1)
+            {
+                printf("%s", usage);
+                return 1;
+            }
+            break;
+        case 'd':
+            demand_paging = TRUE;
+            demand_frames = atoi(optarg);
+            if (demand_frames < 0)
+            {
+                printf("%s", usage);
+                return 1;
+            }
+            break;
+        case 'r':
+            if (frames_parse_policy(optarg, &frame_policy) != 0)
+            {
+                printf("%s", usage);
+                return 1;
+            }
+            break;
+        case 'W':
+        {
+            char *end;
+            long window = strtol(optarg, &end, 10);
+            if (end == optarg || *end != '\0' || window < 0 || window > UINT32_MAX)
+            {
+                printf("%s", usage);
+                return 1;
+            }
+            ws_window = (uint32_t)window;
+            break;
+        }
+        case 'b':
+            batch_mode = TRUE;
+            summary_mode = TRUE;
+            break;
+        case 'j':
+            jobs = atoi(optarg);
+            if (jobs < 1)
+            {
+                printf("%s", usage);
+                return 1;
+            }
+            break;
+        case 'k':
+        {
+            char *end;
+            long at = strtol(optarg, &end, 10);
+            if (end == optarg || *end != ':' || end[1] == '\0' || at < 1)
+            {
+                printf("%s", usage);
+                return 1;
+            }
+            checkpoint_at = (uint32_t)at;
+            checkpoint_path = end + 1;
+            break;
+        }
+        case 'R':
+            restore_path = optarg;
+            break;
+        case 'A':
+            analyze_mode = TRUE;
+            break;
+        case 'n':
+            analysis.windows = optarg;
+            break;
+        case 'p':
+        {
+            char *end;
+            long hot_pages = strtol(optarg, &end, 10);
+            if (end == optarg || *end != '\0' || hot_pages < 0 || hot_pages > INT_MAX)
+            {
+                printf("%s", usage);
+                return 1;
+            }
+            analysis.hot_pages = (int)hot_pages;
+            break;
+        }
+        default:
+            printf("%s", usage);
+            return 1;
+        }
+    }
+    if (jobs < 1)
+    {
+        jobs = 1;
+    }
+    if (argc - optind != 3 || ((sweep_mode || batch_mode || analyze_mode) && (checkpoint_path != NULL || restore_path != NULL)))
+    {
+        printf("%s", usage);
+        return 1;
+    }
+    input_trace = argv[optind + 1];
+    output_trace = argv[optind + 2];
+
+    // Open input and output files
+    FILE *input_file = fopen(input_trace, "r");
+    if (input_file == NULL)
+    {
+        fprintf(stderr, "Error: cannot open %s\n", input_trace);
+        return 1;
+    }
+    FILE *output_file = fopen(output_trace, "w");
+    if (output_file == NULL)
+    {
+        fprintf(stderr, "Error: cannot open %s\n", output_trace);
+        return 1;
+    }
+
+    if (sweep_mode)
+    {
+        struct SweepConfig config = {argv[optind], tlb_sizes, tlb_ways, fill_on_miss, asid_pool, cost};
+        int status = sweep(input_file, output_file, &config);
+        fclose(input_file);
+        fclose(output_file);
+        return status == 0 ? 0 : 1;
+    }
+
+    if (analyze_mode)
+    {
+        int status = analyze(input_file, output_file, &analysis);
+        fclose(input_file);
+        fclose(output_file);
+        return status == 0 ? 0 : 1;
+    }
+
+    if (tlb_parse_policy(argv[optind], &strategy) != 0)
+    {
+        fprintf(stderr, "Error: unknown strategy %s\n", argv[optind]);
+        return 1;
+    }
+
+    int status;
+    if (batch_mode)
+    {
+        status = run_batch(input_file, output_file, atoi(tlb_sizes), atoi(tlb_ways), asid_pool, jobs);
+    }
+    else
+    {
+        struct Simulation sim;
+        if (simulation_init(&sim, output_file, atoi(tlb_sizes), atoi(tlb_ways), asid_pool) != 0)
+        {
+            fprintf(stderr, "Error: invalid TLB geometry %s entries, %s ways\n", tlb_sizes, tlb_ways);
+            return 1;
+        }
+
+        if (restore_path != NULL && checkpoint_restore(&sim, input_file, restore_path) != 0)
+        {
+            fprintf(stderr, "Error: cannot restore %s, or it was saved with other options\n", restore_path);
+            simulation_free(&sim);
+            return 1;
+        }
+        status = run_trace(&sim, input_file);
+
+        if (summary_mode)
+        {
+            write_summary(&sim);
+        }
+        simulation_free(&sim);
+    }
 
     // close input and output files
     fclose(input_file);
     fclose(output_file);
 
-    return 0;
-}
\ No newline at end of file
+    return status == 0 ? 0 : 1;
+}
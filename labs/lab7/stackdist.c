@@ -0,0 +1,232 @@
+#include <stdlib.h>
+#include <string.h>
+#include "stackdist.h"
+
+#define SD_EMPTY (-1)
+#define SD_HOLE (-2)
+
+#define INITIAL_CAPACITY 4096
+
+// Add delta to slot i of the Fenwick tree
+static void tree_add(struct StackDist *sd, int i, int delta)
+{
+    for (i++; i <= sd->capacity; i += i & -i)
+    {
+        sd->tree[i] += delta;
+    }
+}
+
+// Number of non-empty slots in [0, i)
+static int tree_prefix(struct StackDist *sd, int i)
+{
+    int sum = 0;
+    for (; i > 0; i -= i & -i)
+    {
+        sum += sd->tree[i];
+    }
+    return sum;
+}
+
+// The heap never outgrows num_keys: a hole is only made when a key leaves the
+// stack, and a key only returns to the stack by filling a hole if one exists.
+static void holes_push(struct StackDist *sd, int slot)
+{
+    int i = sd->num_holes++;
+    while (i > 0 && sd->holes[(i - 1) / 2] < slot)
+    {
+        sd->holes[i] = sd->holes[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    sd->holes[i] = slot;
+}
+
+static int holes_pop(struct StackDist *sd)
+{
+    int top = sd->holes[0];
+    int slot = sd->holes[--sd->num_holes];
+    int i = 0;
+    for (;;)
+    {
+        int child = 2 * i + 1;
+        if (child >= sd->num_holes)
+        {
+            break;
+        }
+        if (child + 1 < sd->num_holes && sd->holes[child + 1] > sd->holes[child])
+        {
+            child++;
+        }
+        if (sd->holes[child] <= slot)
+        {
+            break;
+        }
+        sd->holes[i] = sd->holes[child];
+        i = child;
+    }
+    sd->holes[i] = slot;
+    return top;
+}
+
+// Renumber the non-empty slots to 0 .. live - 1, keeping their order, so that
+// new accesses have room at the end. Grows the slot arrays if they are more
+// than half full afterwards.
+static int compact(struct StackDist *sd)
+{
+    int new_capacity = sd->capacity;
+    if (2 * sd->live >= sd->capacity)
+    {
+        new_capacity = 2 * sd->capacity;
+    }
+
+    int *owner = malloc(new_capacity * sizeof(int));
+    int *tree = calloc(new_capacity + 1, sizeof(int));
+    if (owner == NULL || tree == NULL)
+    {
+        free(owner);
+        free(tree);
+        return -1;
+    }
+
+    int j = 0;
+    sd->num_holes = 0;
+    for (int i = 0; i < sd->now; i++)
+    {
+        if (sd->owner[i] == SD_EMPTY)
+        {
+            continue;
+        }
+        owner[j] = sd->owner[i];
+        if (owner[j] == SD_HOLE)
+        {
+            // slots are visited in increasing order, so this never sifts
+            sd->holes[sd->num_holes++] = j;
+        }
+        else
+        {
+            sd->last[owner[j]] = j;
+        }
+        j++;
+    }
+    for (int i = j; i < new_capacity; i++)
+    {
+        owner[i] = SD_EMPTY;
+    }
+
+    // linear-time Fenwick build over j leading ones
+    for (int i = 1; i <= new_capacity; i++)
+    {
+        tree[i] += (i <= j);
+        int parent = i + (i & -i);
+        if (parent <= new_capacity)
+        {
+            tree[parent] += tree[i];
+        }
+    }
+
+    // the heap is a max-heap; reverse the ascending hole list into one
+    for (int a = 0, b = sd->num_holes - 1; a < b; a++, b--)
+    {
+        int t = sd->holes[a];
+        sd->holes[a] = sd->holes[b];
+        sd->holes[b] = t;
+    }
+
+    free(sd->owner);
+    free(sd->tree);
+    sd->owner = owner;
+    sd->tree = tree;
+    sd->capacity = new_capacity;
+    sd->now = j;
+    return 0;
+}
+
+int stackdist_init(struct StackDist *sd, int num_keys)
+{
+    memset(sd, 0, sizeof(*sd));
+    sd->num_keys = num_keys;
+    sd->capacity = INITIAL_CAPACITY;
+    sd->last = malloc(num_keys * sizeof(int));
+    sd->owner = malloc(sd->capacity * sizeof(int));
+    sd->tree = calloc(sd->capacity + 1, sizeof(int));
+    sd->holes = malloc(num_keys * sizeof(int));
+    if (sd->last == NULL || sd->owner == NULL || sd->tree == NULL || sd->holes == NULL)
+    {
+        stackdist_free(sd);
+        return -1;
+    }
+    for (int i = 0; i < num_keys; i++)
+    {
+        sd->last[i] = -1;
+    }
+    for (int i = 0; i < sd->capacity; i++)
+    {
+        sd->owner[i] = SD_EMPTY;
+    }
+    return 0;
+}
+
+void stackdist_free(struct StackDist *sd)
+{
+    free(sd->last);
+    free(sd->owner);
+    free(sd->tree);
+    free(sd->holes);
+    memset(sd, 0, sizeof(*sd));
+}
+
+int stackdist_access(struct StackDist *sd, int key)
+{
+    if (sd->now == sd->capacity && compact(sd) != 0)
+    {
+        return -1;
+    }
+
+    int t = sd->last[key];
+    int depth = stackdist_depth(sd, key);
+
+    if (sd->num_holes > 0 && (t < 0 || sd->holes[0] > t))
+    {
+        // the shallowest hole is above the key: caches too small to hold the
+        // key fill that hole, and the key's old position becomes the hole
+        int hole = holes_pop(sd);
+        sd->owner[hole] = SD_EMPTY;
+        tree_add(sd, hole, -1);
+        sd->live--;
+        if (t >= 0)
+        {
+            sd->owner[t] = SD_HOLE;
+            holes_push(sd, t);
+        }
+    }
+    else if (t >= 0)
+    {
+        sd->owner[t] = SD_EMPTY;
+        tree_add(sd, t, -1);
+        sd->live--;
+    }
+
+    sd->owner[sd->now] = key;
+    tree_add(sd, sd->now, 1);
+    sd->last[key] = sd->now;
+    sd->now++;
+    sd->live++;
+    return depth;
+}
+
+int stackdist_depth(struct StackDist *sd, int key)
+{
+    int t = sd->last[key];
+    return t < 0 ? 0 : sd->live - tree_prefix(sd, t);
+}
+
+void stackdist_remove(struct StackDist *sd, int key)
+{
+    int t = sd->last[key];
+    if (t < 0)
+    {
+        return;
+    }
+    sd->owner[t] = SD_HOLE;
+    holes_push(sd, t);
+    sd->last[key] = -1;
+}
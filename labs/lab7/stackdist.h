@@ -0,0 +1,40 @@
+#ifndef __stackdist_h__
+#define __stackdist_h__
+
+// LRU stack distances in O(log n) per access (Bennett & Kruskal).
+//
+// Every key on the LRU stack owns the time slot of its most recent access,
+// and a Fenwick tree over the slots counts how many keys were touched since
+// then. Invalidating a key leaves a hole at its position instead of closing
+// the gap: an LRU cache of any size that held the key now has a free entry,
+// and the next insertion above the hole fills it without evicting anything.
+// With holes, one stack gives the exact hit count of every LRU cache size.
+struct StackDist
+{
+    int num_keys;
+    int *last;     // per key, slot of its last access or -1 if not on the stack
+    int *owner;    // per slot, the key, SD_HOLE or SD_EMPTY
+    int *tree;     // Fenwick tree over slots, 1 for every non-empty slot
+    int capacity;  // number of slots
+    int now;       // next free slot
+    int live;      // number of non-empty slots
+    int *holes;    // max-heap of hole slots
+    int num_holes;
+};
+
+// Allocate a stack for keys 0 .. num_keys - 1. Return 0 on success, -1 otherwise.
+int stackdist_init(struct StackDist *sd, int num_keys);
+void stackdist_free(struct StackDist *sd);
+
+// Move key to the top of the stack. Return its previous 1-based depth, or 0
+// if it was not on the stack, or -1 if memory ran out. A cache of size n
+// hits iff 0 < depth <= n.
+int stackdist_access(struct StackDist *sd, int key);
+
+// Current 1-based depth of key, or 0 if it is not on the stack.
+int stackdist_depth(struct StackDist *sd, int key);
+
+// Take key off the stack, leaving a hole where it was.
+void stackdist_remove(struct StackDist *sd, int key);
+
+#endif
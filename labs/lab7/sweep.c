@@ -0,0 +1,402 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "sweep.h"
+#include "tlb.h"
+#include "stackdist.h"
+#include "asid.h"
+#include "trace.h"
+
+#define TRUE 1
+#define FALSE 0
+
+#define MAX_LIST 64
+
+// One simulated TLB configuration
+struct Model
+{
+    enum TLBPolicy policy;
+    int entries;
+    int ways;
+    int from_stack; // hit count comes from the LRU stack, not from tlb
+    struct TLB tlb;
+    uint64_t hits;
+    uint64_t flushed; // entries dropped by context switches
+};
+
+// Parse a comma-separated list of non-negative integers. Return the number of
+// values parsed, or -1 on a malformed list.
+static int parse_int_list(const char *list, int *values)
+{
+    int count = 0;
+    const char *p = list;
+    while (*p != '\0')
+    {
+        char *end;
+        long value = strtol(p, &end, 10);
+        if (end == p || value < 0 || count == MAX_LIST || (*end != ',' && *end != '\0'))
+        {
+            return -1;
+        }
+        values[count++] = (int)value;
+        p = (*end == ',') ? end + 1 : end;
+    }
+    return count;
+}
+
+static int parse_policy_list(const char *list, enum TLBPolicy *policies)
+{
+    char buffer[256];
+    int count = 0;
+
+    if (strlen(list) >= sizeof(buffer))
+    {
+        return -1;
+    }
+    strcpy(buffer, list);
+    for (char *name = strtok(buffer, ","); name != NULL; name = strtok(NULL, ","))
+    {
+        if (count == MAX_LIST || tlb_parse_policy(name, &policies[count]) != 0)
+        {
+            return -1;
+        }
+        count++;
+    }
+    return count;
+}
+
+int sweep(FILE *input, FILE *output, struct SweepConfig *config)
+{
+    enum TLBPolicy policy_list[MAX_LIST];
+    int size_list[MAX_LIST];
+    int ways_list[MAX_LIST];
+    int num_policies = parse_policy_list(config->strategies, policy_list);
+    int num_sizes = parse_int_list(config->sizes, size_list);
+    int num_ways = parse_int_list(config->ways, ways_list);
+    int fill_on_miss = config->fill_on_miss;
+
+    if (num_policies <= 0 || num_sizes <= 0 || num_ways <= 0)
+    {
+        fprintf(stderr, "Error: malformed sweep configuration\n");
+        return -1;
+    }
+
+    // build one model per valid combination
+    struct Model *models = calloc(num_policies * num_sizes * num_ways, sizeof(struct Model));
+    if (models == NULL)
+    {
+        fprintf(stderr, "Error: out of memory\n");
+        return -1;
+    }
+    int num_models = 0;
+    int max_stack_size = 0;
+    for (int p = 0; p < num_policies; p++)
+    {
+        for (int s = 0; s < num_sizes; s++)
+        {
+            for (int w = 0; w < num_ways; w++)
+            {
+                int entries = size_list[s];
+                int assoc = ways_list[w] == 0 ? entries : ways_list[w];
+                if (entries == 0 || assoc > entries || entries % assoc != 0)
+                {
+                    continue;
+                }
+
+                // "0" and an explicit ways == entries describe the same TLB
+                int duplicate = FALSE;
+                for (int i = 0; i < num_models; i++)
+                {
+                    if (models[i].policy == policy_list[p] && models[i].entries == entries && models[i].ways == assoc)
+                    {
+                        duplicate = TRUE;
+                    }
+                }
+                if (duplicate)
+                {
+                    continue;
+                }
+
+                struct Model *m = &models[num_models];
+                m->policy = policy_list[p];
+                m->entries = entries;
+                m->ways = assoc;
+                m->from_stack = fill_on_miss && m->policy == POLICY_LRU && assoc == entries;
+                if (m->from_stack)
+                {
+                    if (entries > max_stack_size)
+                    {
+                        max_stack_size = entries;
+                    }
+                }
+                else if (tlb_init(&m->tlb, entries, assoc, m->policy) != 0)
+                {
+                    fprintf(stderr, "Error: could not allocate a TLB with %d entries\n", entries);
+                    return -1;
+                }
+                num_models++;
+            }
+        }
+    }
+
+    // histograms of LRU stack depths at hits and at flushes; depth 0 (not on
+    // the stack) and depths beyond the largest simulated size are not counted
+    uint64_t *depths = calloc(max_stack_size + 1, sizeof(uint64_t));
+    uint64_t *flushed_depths = calloc(max_stack_size + 1, sizeof(uint64_t));
+    struct StackDist stack;
+    int use_stack = max_stack_size > 0;
+    struct ASIDPool asids;
+    uint64_t flushes = 0;
+
+    asid_init(&asids, config->asid_pool, 0);
+
+    char buffer[1024];
+    int memory_initialized = FALSE;
+    int current_process = 0;
+    int off = 0;
+    int num_pages = 0;
+    char *valid = NULL; // page table valid bits, 4 processes x num_pages
+    uint32_t timestamp = 0;
+    uint64_t accesses = 0;
+    uint64_t faults = 0; // accesses to unmapped pages
+    int status = 0;
+
+    while (trace_gets(buffer, sizeof(buffer), input) != NULL)
+    {
+        if (buffer[0] == '%')
+        {
+            continue;
+        }
+        timestamp++;
+
+        char *op = strtok(buffer, " \n");
+        char *arg1 = op ? strtok(NULL, " \n") : NULL;
+        char *arg2 = arg1 ? strtok(NULL, " \n") : NULL;
+        if (op == NULL)
+        {
+            continue;
+        }
+
+        if (strcmp(op, "define") == 0)
+        {
+            char *arg3 = arg2 ? strtok(NULL, " \n") : NULL;
+            if (memory_initialized || arg3 == NULL)
+            {
+                fprintf(stderr, "Error: invalid define\n");
+                status = -1;
+                break;
+            }
+            off = atoi(arg1);
+            num_pages = 1 << atoi(arg3);
+            valid = calloc(4 * num_pages, 1);
+            if (use_stack && stackdist_init(&stack, 4 * num_pages) != 0)
+            {
+                fprintf(stderr, "Error: could not allocate the LRU stack\n");
+                status = -1;
+                break;
+            }
+            memory_initialized = TRUE;
+            continue;
+        }
+
+        if (strcmp(op, "ctxswitch") == 0)
+        {
+            int new_pid = arg1 ? atoi(arg1) : -1;
+            if (new_pid < 0 || new_pid > 3)
+            {
+                fprintf(stderr, "Error: invalid context switch to process %d\n", new_pid);
+                status = -1;
+                break;
+            }
+            current_process = new_pid;
+
+            int victim = asid_switch(&asids, new_pid, timestamp);
+            if (victim == -1)
+            {
+                continue;
+            }
+            flushes++;
+            for (int i = 0; i < num_models; i++)
+            {
+                if (!models[i].from_stack)
+                {
+                    models[i].flushed += tlb_flush(&models[i].tlb, victim);
+                }
+            }
+            for (int vpn = 0; use_stack && memory_initialized && vpn < num_pages; vpn++)
+            {
+                int key = victim * num_pages + vpn;
+                int depth = stackdist_depth(&stack, key);
+                if (depth > 0 && depth <= max_stack_size)
+                {
+                    flushed_depths[depth]++;
+                }
+                stackdist_remove(&stack, key);
+            }
+            continue;
+        }
+
+        int is_map = strcmp(op, "map") == 0;
+        int is_unmap = strcmp(op, "unmap") == 0;
+        int is_store = strcmp(op, "store") == 0;
+        int is_load = strcmp(op, "load") == 0;
+        if (!is_map && !is_unmap && !is_store && !is_load)
+        {
+            continue;
+        }
+        if (!memory_initialized)
+        {
+            fprintf(stderr, "Error: %s before define\n", op);
+            status = -1;
+            break;
+        }
+
+        char *address = is_load ? arg2 : arg1;
+        if (address == NULL || (is_map && arg2 == NULL))
+        {
+            fprintf(stderr, "Error: malformed %s instruction\n", op);
+            status = -1;
+            break;
+        }
+        if (is_load && address[0] == '#')
+        {
+            continue;
+        }
+
+        int vpn = (is_map || is_unmap) ? atoi(address) : (atoi(address) >> off);
+        int in_range = vpn >= 0 && vpn < num_pages;
+        int key = current_process * num_pages + vpn;
+
+        if (is_map)
+        {
+            if (!in_range)
+            {
+                fprintf(stderr, "Error: invalid VPN %d\n", vpn);
+                status = -1;
+                break;
+            }
+            int pfn = atoi(arg2);
+            valid[key] = TRUE;
+            for (int i = 0; i < num_models; i++)
+            {
+                struct Model *m = &models[i];
+                int evicted;
+                if (m->from_stack)
+                {
+                    continue;
+                }
+                if (!fill_on_miss)
+                {
+                    tlb_map(&m->tlb, current_process, vpn, pfn, timestamp, &evicted);
+                }
+                else
+                {
+                    int index = tlb_find(&m->tlb, current_process, vpn);
+                    if (index != -1)
+                    {
+                        m->tlb.pfn[index] = pfn;
+                    }
+                }
+            }
+        }
+        else if (is_unmap)
+        {
+            if (!in_range)
+            {
+                continue;
+            }
+            valid[key] = FALSE;
+            for (int i = 0; i < num_models; i++)
+            {
+                if (!models[i].from_stack)
+                {
+                    tlb_invalidate(&models[i].tlb, current_process, vpn);
+                }
+            }
+            if (use_stack)
+            {
+                stackdist_remove(&stack, key);
+            }
+        }
+        else
+        {
+            int mapped = in_range && valid[key];
+            accesses++;
+            faults += !mapped;
+            for (int i = 0; i < num_models; i++)
+            {
+                struct Model *m = &models[i];
+                int evicted;
+                if (m->from_stack)
+                {
+                    continue;
+                }
+                if (tlb_lookup(&m->tlb, current_process, vpn, timestamp) != -1)
+                {
+                    m->hits++;
+                }
+                else if (fill_on_miss && mapped)
+                {
+                    tlb_insert(&m->tlb, current_process, vpn, 0, timestamp, &evicted);
+                }
+            }
+            if (use_stack && mapped)
+            {
+                int depth = stackdist_access(&stack, key);
+                if (depth < 0)
+                {
+                    fprintf(stderr, "Error: could not grow the LRU stack\n");
+                    status = -1;
+                    break;
+                }
+                if (depth <= max_stack_size)
+                {
+                    depths[depth]++;
+                }
+            }
+        }
+    }
+
+    if (status == 0)
+    {
+        fprintf(output, "policy,entries,ways,accesses,hits,misses,hit_rate,miss_rate,flushes,flushed_entries,cycles,amat\n");
+        for (int i = 0; i < num_models; i++)
+        {
+            struct Model *m = &models[i];
+            if (m->from_stack)
+            {
+                for (int d = 1; d <= m->entries; d++)
+                {
+                    m->hits += depths[d];
+                    m->flushed += flushed_depths[d];
+                }
+            }
+            double hit_rate = accesses ? (double)m->hits / accesses : 0.0;
+            uint64_t cycles = cost_cycles(&config->cost, accesses, accesses - m->hits, accesses - faults);
+            fprintf(output, "%s,%d,%d,%llu,%llu,%llu,%.6f,%.6f,%llu,%llu,%llu,%.6f\n",
+                    tlb_policy_name(m->policy), m->entries, m->ways,
+                    (unsigned long long)accesses, (unsigned long long)m->hits,
+                    (unsigned long long)(accesses - m->hits), hit_rate, accesses ? 1.0 - hit_rate : 0.0,
+                    (unsigned long long)flushes, (unsigned long long)m->flushed,
+                    (unsigned long long)cycles, accesses ? (double)cycles / accesses : 0.0);
+        }
+    }
+
+    for (int i = 0; i < num_models; i++)
+    {
+        if (!models[i].from_stack)
+        {
+            tlb_free(&models[i].tlb);
+        }
+    }
+    if (use_stack && memory_initialized)
+    {
+        stackdist_free(&stack);
+    }
+    free(models);
+    free(depths);
+    free(flushed_depths);
+    free(valid);
+    return status;
+}
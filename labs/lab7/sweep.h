@@ -0,0 +1,30 @@
+#ifndef __sweep_h__
+#define __sweep_h__
+
+#include <stdio.h>
+#include "cost.h"
+
+struct SweepConfig
+{
+    const char *strategies; // comma-separated strategy names
+    const char *sizes;      // comma-separated TLB sizes
+    const char *ways;       // comma-separated associativities, 0 = fully associative
+    int fill_on_miss;       // translations enter the TLB on a miss instead of on map
+    int asid_pool;          // ASIDs available to context switches, see asid.h
+    struct CostModel cost;  // latencies behind the cycles and amat columns
+};
+
+// Replay a trace once against every combination of strategies, TLB sizes and
+// associativities, and write one CSV row of hit and miss rates, context
+// switch flushes and simulated cycles per TLB configuration.
+//
+// Only the translation side of the trace is modelled: define, ctxswitch, map,
+// unmap, and the memory operands of load and store. An access to an unmapped
+// page counts as a miss in every TLB, pays for the walk but not for the
+// memory access, and the replay continues.
+//
+// With fill_on_miss, all fully associative LRU sizes come from a single LRU
+// stack. Return 0 on success, -1 on a malformed configuration or trace.
+int sweep(FILE *input, FILE *output, struct SweepConfig *config);
+
+#endif
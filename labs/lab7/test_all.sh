@@ -29,3 +29,63 @@ cd test_complex5
 ./test_complex5.py
 cd ..
 echo "Done!"
+
+echo "Running test batch 6: sweep tests"
+cd test_sweep6
+./test_sweep6.py
+cd ..
+echo "Done!"
+
+echo "Running test batch 7: summary tests"
+cd test_summary7
+./test_summary7.py
+cd ..
+echo "Done!"
+
+echo "Running test batch 8: replacement strategy tests"
+cd test_policies8
+./test_policies8.py
+cd ..
+echo "Done!"
+
+echo "Running test batch 9: ASID tests"
+cd test_asid9
+./test_asid9.py
+cd ..
+echo "Done!"
+
+echo "Running test batch 10: cost model tests"
+cd test_cost10
+./test_cost10.py
+cd ..
+echo "Done!"
+
+echo "Running test batch 11: demand paging tests"
+cd test_demand11
+./test_demand11.py
+cd ..
+echo "Done!"
+
+echo "Running test batch 12: batch mode tests"
+cd test_batch12
+./test_batch12.py
+cd ..
+echo "Done!"
+
+echo "Running test batch 13: checkpoint and restore tests"
+cd test_checkpoint13
+./test_checkpoint13.py
+cd ..
+echo "Done!"
+
+echo "Running test batch 14: trace analysis tests"
+cd test_analyze14
+./test_analyze14.py
+cd ..
+echo "Done!"
+
+echo "Running test batch 15: trace generator tests"
+cd test_tracegen15
+./test_tracegen15.py
+cd ..
+echo "Done!"
@@ -0,0 +1,20 @@
+#!/usr/bin/python3
+
+import sys
+import os
+
+def run_test(test_name, options, trace_file, output_file):
+    sys.stdout.write("Running test " + test_name + "... ")
+    os.system("../memsym.out " + options + " " + trace_file + " temp.txt > /dev/null 2> /dev/null")
+    if os.system("diff temp.txt " + output_file + " > /dev/null") != 0:
+        print("\033[91mFAILED\033[0m")
+        sys.exit(1)
+    else:
+        print("\033[92mPASSED\033[0m")
+
+tests = [("Test 14.1: working sets, stack distances and hot pages", "-A -n 5,20 LRU", "test14.1.in", "test14.1.out"),
+         ("Test 14.2: analysis with a small window and three hot pages", "-A -n 4 -p 3 FIFO", "test14.2.in", "test14.2.out")]
+
+for test in tests:
+    run_test(*test)
+os.system("rm -f temp.txt")
@@ -0,0 +1,21 @@
+#!/usr/bin/python3
+
+import sys
+import os
+
+def run_test(test_name, options, trace_file, output_file):
+    sys.stdout.write("Running test " + test_name + "... ")
+    os.system("../memsym.out " + options + " " + trace_file + " temp.txt > /dev/null 2> /dev/null")
+    if os.system("diff temp.txt " + output_file + " > /dev/null") != 0:
+        print("\033[91mFAILED\033[0m")
+        sys.exit(1)
+    else:
+        print("\033[92mPASSED\033[0m")
+
+tests = [("Test 9.1: flush on every context switch", "-q -a flush FIFO", "test9.1.in", "test9.1.out"),
+         ("Test 9.2: two recycled ASIDs, fill on miss", "-q -f miss -a 2 LRU", "test9.2.in", "test9.2.out"),
+         ("Test 9.3: sweep with two recycled ASIDs, fill on miss", "-s -f miss -a 2 -t 2,4,8 FIFO,LRU", "test9.3.in", "test9.3.out")]
+
+for test in tests:
+    run_test(*test)
+os.system("rm -f temp.txt")
@@ -0,0 +1,23 @@
+#!/usr/bin/python3
+
+import sys
+import os
+
+def run_test(test_name, options, trace_file, output_file):
+    sys.stdout.write("Running test " + test_name + "... ")
+    os.system("../memsym.out " + options + " " + trace_file + " temp.txt > /dev/null 2> /dev/null")
+    if os.system("diff temp.txt " + output_file + " > /dev/null") != 0:
+        print("\033[91mFAILED\033[0m")
+        sys.exit(1)
+    else:
+        print("\033[92mPASSED\033[0m")
+
+# each restore resumes from the checkpoint written by the test before it
+tests = [("Test 13.1: checkpoint under demand paging", "-k 25:test13.1.ck -d 3 -r CLOCK ARC", "test13.1.in", "test13.1.out"),
+         ("Test 13.2: restore under demand paging", "-R test13.1.ck -d 3 -r CLOCK ARC", "test13.1.in", "test13.2.out"),
+         ("Test 13.3: checkpoint of a set-associative LFU TLB", "-q -t 4 -w 2 -a 2 -k 60:test13.3.ck LFU", "test13.3.in", "test13.3.out"),
+         ("Test 13.4: restore of a set-associative LFU TLB", "-q -t 4 -w 2 -a 2 -R test13.3.ck LFU", "test13.3.in", "test13.4.out")]
+
+for test in tests:
+    run_test(*test)
+os.system("rm -f temp.txt test13.1.ck test13.3.ck")
@@ -0,0 +1,21 @@
+#!/usr/bin/python3
+
+import sys
+import os
+
+def run_test(test_name, options, trace_file, output_file):
+    sys.stdout.write("Running test " + test_name + "... ")
+    os.system("../memsym.out " + options + " " + trace_file + " temp.txt > /dev/null 2> /dev/null")
+    if os.system("diff temp.txt " + output_file + " > /dev/null") != 0:
+        print("\033[91mFAILED\033[0m")
+        sys.exit(1)
+    else:
+        print("\033[92mPASSED\033[0m")
+
+tests = [("Test 11.1: demand paging, LRU replacement", "-d 3 -r LRU LRU", "test11.1.in", "test11.1.out"),
+         ("Test 11.2: demand paging, CLOCK replacement", "-q -d 3 -r CLOCK LRU", "test11.2.in", "test11.2.out"),
+         ("Test 11.3: demand paging, working-set replacement", "-q -d 3 -r WS -W 10 LRU", "test11.3.in", "test11.3.out")]
+
+for test in tests:
+    run_test(*test)
+os.system("rm -f temp.txt")
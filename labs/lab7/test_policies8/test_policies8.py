@@ -0,0 +1,21 @@
+#!/usr/bin/python3
+
+import sys
+import os
+
+def run_test(test_name, options, trace_file, output_file):
+    sys.stdout.write("Running test " + test_name + "... ")
+    os.system("../memsym.out " + options + " " + trace_file + " temp.txt > /dev/null 2> /dev/null")
+    if os.system("diff temp.txt " + output_file + " > /dev/null") != 0:
+        print("\033[91mFAILED\033[0m")
+        sys.exit(1)
+    else:
+        print("\033[92mPASSED\033[0m")
+
+tests = [("Test 8.1: CLOCK TLB replacement strategy", "-t 4 CLOCK", "test8.1.in", "test8.1.out"),
+         ("Test 8.2: LFU TLB replacement strategy", "-t 4 LFU", "test8.2.in", "test8.2.out"),
+         ("Test 8.3: ARC TLB replacement strategy", "-t 4 ARC", "test8.3.in", "test8.3.out")]
+
+for test in tests:
+    run_test(*test)
+os.system("rm -f temp.txt")
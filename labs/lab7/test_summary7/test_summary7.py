@@ -0,0 +1,20 @@
+#!/usr/bin/python3
+
+import sys
+import os
+
+def run_test(test_name, options, trace_file, output_file):
+    sys.stdout.write("Running test " + test_name + "... ")
+    os.system("../memsym.out " + options + " " + trace_file + " temp.txt > /dev/null 2> /dev/null")
+    if os.system("diff temp.txt " + output_file + " > /dev/null") != 0:
+        print("\033[91mFAILED\033[0m")
+        sys.exit(1)
+    else:
+        print("\033[92mPASSED\033[0m")
+
+tests = [("Test 7.1: summary of a multi-process trace", "-q FIFO", "test7.1.in", "test7.1.out"),
+         ("Test 7.2: summary after a page fault", "-q FIFO", "test7.2.in", "test7.2.out")]
+
+for test in tests:
+    run_test(*test)
+os.system("rm -f temp.txt")
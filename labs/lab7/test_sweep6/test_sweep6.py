@@ -0,0 +1,20 @@
+#!/usr/bin/python3
+
+import sys
+import os
+
+def run_test(test_name, options, trace_file, output_file):
+    sys.stdout.write("Running test " + test_name + "... ")
+    os.system("../memsym.out " + options + " " + trace_file + " temp.txt > /dev/null 2> /dev/null")
+    if os.system("diff temp.txt " + output_file + " > /dev/null") != 0:
+        print("\033[91mFAILED\033[0m")
+        sys.exit(1)
+    else:
+        print("\033[92mPASSED\033[0m")
+
+tests = [("Test 6.1: sweep, fill on map", "-s -t 1,2,4,8 -w 0,1 FIFO,LRU", "test6.1.in", "test6.1.out"),
+         ("Test 6.2: sweep, fill on miss", "-s -f miss -t 1,2,4,8 -w 0,1 FIFO,LRU", "test6.2.in", "test6.2.out")]
+
+for test in tests:
+    run_test(*test)
+os.system("rm -f temp.txt")
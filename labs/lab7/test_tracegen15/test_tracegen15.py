@@ -0,0 +1,26 @@
+#!/usr/bin/python3
+
+import sys
+import os
+
+def run_test(test_name, commands, output_file):
+    sys.stdout.write("Running test " + test_name + "... ")
+    for command in commands:
+        os.system(command + " > /dev/null 2> /dev/null")
+    if os.system("diff temp.txt " + output_file + " > /dev/null") != 0:
+        print("\033[91mFAILED\033[0m")
+        sys.exit(1)
+    else:
+        print("\033[92mPASSED\033[0m")
+
+tests = [("Test 15.1: generated zipf trace", ["../tracegen.out -m zipf -n 200 -P 2 -v 5 -x 20 -r 15 temp.txt"], "test15.1.out"),
+         ("Test 15.2: simulation of a compiled phase trace",
+          ["../tracegen.out -c -m phase -n 400 -v 6 -l 50 -k 4 -x 50 -r 15 temp.bin",
+           "../memsym.out -q -f miss -t 16 LRU temp.bin temp.txt"], "test15.2.out"),
+         ("Test 15.3: simulation of a compiled hand-written trace",
+          ["../tracegen.out -C test15.3.in temp.bin",
+           "../memsym.out FIFO temp.bin temp.txt"], "test15.3.out")]
+
+for test in tests:
+    run_test(*test)
+os.system("rm -f temp.txt temp.bin")
@@ -0,0 +1,275 @@
+#include <stdlib.h>
+#include <string.h>
+#include "tlb.h"
+#include "tlbpolicy.h"
+#include "tlbprobe.h"
+#include "checkpoint.h"
+
+#define TRUE 1
+#define FALSE 0
+
+int tlb_parse_policy(const char *name, enum TLBPolicy *policy)
+{
+    for (int i = 0; i < NUM_POLICIES; i++)
+    {
+        if (strcmp(name, tlb_policy_ops(i)->name) == 0)
+        {
+            *policy = i;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+const char *tlb_policy_name(enum TLBPolicy policy)
+{
+    return tlb_policy_ops(policy)->name;
+}
+
+int tlb_init(struct TLB *tlb, int num_entries, int ways, enum TLBPolicy policy)
+{
+    if (ways == 0)
+    {
+        ways = num_entries;
+    }
+    if (num_entries <= 0 || ways <= 0 || num_entries % ways != 0)
+    {
+        return -1;
+    }
+
+    // initialize TLB entries as invalid, with an invalid process ID. The tag
+    // arrays are padded for the vector probes, which read whole blocks.
+    int padded = num_entries + TLB_PROBE_PAD;
+    tlb->valid = calloc((padded + 63) / 64 + 1, sizeof(uint64_t));
+    tlb->vpn = calloc(padded, sizeof(int32_t));
+    tlb->pfn = calloc(num_entries, sizeof(int32_t));
+    tlb->process_id = malloc(padded * sizeof(int8_t));
+    tlb->timestamp = calloc(num_entries, sizeof(uint32_t));
+    tlb->state = NULL;
+    tlb->ops = tlb_policy_ops(policy);
+    if (tlb->valid == NULL || tlb->vpn == NULL || tlb->pfn == NULL || tlb->process_id == NULL || tlb->timestamp == NULL)
+    {
+        tlb_free(tlb);
+        return -1;
+    }
+    memset(tlb->process_id, -1, padded * sizeof(int8_t));
+
+    tlb->num_entries = num_entries;
+    tlb->ways = ways;
+    tlb->num_sets = num_entries / ways;
+    tlb->policy = policy;
+    tlb_set_probe(tlb, PROBE_AUTO);
+    if (tlb->ops->init(tlb) != 0)
+    {
+        tlb_free(tlb);
+        return -1;
+    }
+    return 0;
+}
+
+void tlb_free(struct TLB *tlb)
+{
+    tlb->ops->destroy(tlb);
+    tlb->state = NULL;
+    free(tlb->valid);
+    free(tlb->vpn);
+    free(tlb->pfn);
+    free(tlb->process_id);
+    free(tlb->timestamp);
+    tlb->valid = NULL;
+    tlb->vpn = NULL;
+    tlb->pfn = NULL;
+    tlb->process_id = NULL;
+    tlb->timestamp = NULL;
+}
+
+static void set_valid(struct TLB *tlb, int i)
+{
+    tlb->valid[i >> 6] |= (uint64_t)1 << (i & 63);
+}
+
+static void clear_valid(struct TLB *tlb, int i)
+{
+    tlb->valid[i >> 6] &= ~((uint64_t)1 << (i & 63));
+}
+
+// Apply transfer to the geometry, the entry arrays and every state region
+static int transfer_tlb(struct TLB *tlb, FILE *file, int (*transfer)(FILE *, void *, size_t))
+{
+    struct StateRegion regions[TLB_MAX_STATE_REGIONS];
+    int num_regions = tlb->ops->regions(tlb, regions);
+    int n = tlb->num_entries;
+
+    if (transfer(file, tlb->valid, ((n + 63) / 64) * sizeof(uint64_t)) != 0 ||
+        transfer(file, tlb->vpn, n * sizeof(int32_t)) != 0 ||
+        transfer(file, tlb->pfn, n * sizeof(int32_t)) != 0 ||
+        transfer(file, tlb->process_id, n * sizeof(int8_t)) != 0 ||
+        transfer(file, tlb->timestamp, n * sizeof(uint32_t)) != 0)
+    {
+        return -1;
+    }
+    for (int i = 0; i < num_regions; i++)
+    {
+        if (transfer(file, regions[i].data, regions[i].size) != 0)
+        {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static int write_block(FILE *file, void *data, size_t size)
+{
+    return checkpoint_write(file, data, size);
+}
+
+int tlb_save(struct TLB *tlb, FILE *file)
+{
+    int geometry[3] = {tlb->num_entries, tlb->ways, tlb->policy};
+    if (checkpoint_write(file, geometry, sizeof(geometry)) != 0)
+    {
+        return -1;
+    }
+    return transfer_tlb(tlb, file, write_block);
+}
+
+int tlb_restore(struct TLB *tlb, FILE *file)
+{
+    int geometry[3];
+    if (checkpoint_read(file, geometry, sizeof(geometry)) != 0 ||
+        geometry[0] != tlb->num_entries || geometry[1] != tlb->ways || geometry[2] != (int)tlb->policy)
+    {
+        return -1;
+    }
+    return transfer_tlb(tlb, file, checkpoint_read);
+}
+
+int tlb_set_probe(struct TLB *tlb, enum TLBProbe kind)
+{
+    // below a few ways the vector setup costs more than the scalar loop
+    if (kind == PROBE_AUTO && tlb->ways < 8)
+    {
+        kind = PROBE_SCALAR;
+    }
+    TLBProbeFn probe = tlb_probe_select(kind);
+    if (probe == NULL)
+    {
+        return -1;
+    }
+    tlb->probe = probe;
+    return 0;
+}
+
+// First entry index of the set that vpn maps to
+static int set_base(struct TLB *tlb, int vpn)
+{
+    // a fully associative TLB needs no division
+    return tlb->num_sets == 1 ? 0 : ((unsigned int)vpn % tlb->num_sets) * tlb->ways;
+}
+
+// Lowest invalid entry index in [base, base + ways), or -1. Whole words of
+// the bitmap are skipped while they are full.
+static int first_invalid(struct TLB *tlb, int base, int ways)
+{
+    int end = base + ways;
+    int i = base;
+    while (i < end)
+    {
+        uint64_t free_bits = ~tlb->valid[i >> 6] >> (i & 63);
+        if (free_bits != 0)
+        {
+            int index = i + __builtin_ctzll(free_bits);
+            return index < end ? index : -1;
+        }
+        i = (i | 63) + 1;
+    }
+    return -1;
+}
+
+int tlb_find(struct TLB *tlb, int pid, int vpn)
+{
+    return tlb->probe(tlb, set_base(tlb, vpn), tlb->ways, pid, vpn);
+}
+
+int tlb_lookup(struct TLB *tlb, int pid, int vpn, uint32_t timestamp)
+{
+    int i = tlb_find(tlb, pid, vpn);
+    if (i != -1)
+    {
+        tlb->ops->hit(tlb, i);
+        if (tlb->policy == POLICY_LRU)
+        {
+            tlb->timestamp[i] = timestamp;
+        }
+    }
+    return i;
+}
+
+int tlb_insert(struct TLB *tlb, int pid, int vpn, int pfn, uint32_t timestamp, int *evicted)
+{
+    int base = set_base(tlb, vpn);
+
+    // find an empty TLB entry
+    int index = first_invalid(tlb, base, tlb->ways);
+
+    // if all entries are occupied, the strategy picks the one to replace
+    *evicted = (index == -1);
+    index = tlb->ops->place(tlb, base / tlb->ways, index, pid, vpn);
+
+    set_valid(tlb, index);
+    tlb->process_id[index] = pid;
+    tlb->vpn[index] = vpn;
+    tlb->pfn[index] = pfn;
+    tlb->timestamp[index] = timestamp;
+    return index;
+}
+
+int tlb_map(struct TLB *tlb, int pid, int vpn, int pfn, uint32_t timestamp, int *evicted)
+{
+    int index = tlb_find(tlb, pid, vpn);
+    if (index == -1)
+    {
+        return tlb_insert(tlb, pid, vpn, pfn, timestamp, evicted);
+    }
+
+    // remapping counts as a new insertion for FIFO, but not as a use for LRU
+    tlb->pfn[index] = pfn;
+    tlb->ops->remap(tlb, index);
+    if (tlb->policy == POLICY_FIFO)
+    {
+        tlb->timestamp[index] = timestamp;
+    }
+    *evicted = FALSE;
+    return index;
+}
+
+int tlb_invalidate(struct TLB *tlb, int pid, int vpn)
+{
+    int index = tlb_find(tlb, pid, vpn);
+    if (index != -1)
+    {
+        clear_valid(tlb, index);
+        tlb->ops->remove(tlb, index);
+    }
+    return index;
+}
+
+int tlb_flush(struct TLB *tlb, int pid)
+{
+    int flushed = 0;
+    for (int w = 0; w < (tlb->num_entries + 63) / 64; w++)
+    {
+        // visit only the valid entries of each word of the bitmap
+        for (uint64_t bits = tlb->valid[w]; bits != 0; bits &= bits - 1)
+        {
+            int i = w * 64 + __builtin_ctzll(bits);
+            if (tlb->process_id[i] == pid)
+            {
+                clear_valid(tlb, i);
+                tlb->ops->remove(tlb, i);
+                flushed++;
+            }
+        }
+    }
+    return flushed;
+}
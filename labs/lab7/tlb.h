@@ -0,0 +1,102 @@
+#ifndef __tlb_h__
+#define __tlb_h__
+
+#include <stdint.h>
+#include <stdio.h>
+
+// TLB replacement strategies, implemented in tlbpolicy.c
+enum TLBPolicy
+{
+    POLICY_FIFO,
+    POLICY_LRU,
+    POLICY_CLOCK,
+    POLICY_RANDOM,
+    POLICY_LFU,
+    POLICY_ARC,
+    NUM_POLICIES,
+};
+
+struct TLBPolicyOps;
+struct TLB;
+
+// Implementations of the tag comparison in tlb_find, see tlbprobe.c
+enum TLBProbe
+{
+    PROBE_AUTO,   // the fastest one the CPU supports, scalar for small sets
+    PROBE_SCALAR,
+    PROBE_SSE2,   // x86-64 only
+    PROBE_AVX2,   // x86-64 with AVX2 only
+};
+
+typedef int (*TLBProbeFn)(const struct TLB *tlb, int base, int ways, int pid, int vpn);
+
+// A set-associative TLB. Entry i belongs to set i / ways, and a VPN is
+// placed in set vpn % num_sets. A fully associative TLB has a single set.
+//
+// Entries are stored as parallel arrays rather than an array of structs, so
+// the tags of a set are contiguous and a lookup only touches the VPNs, PIDs
+// and valid bits it compares.
+struct TLB
+{
+    int num_entries;
+    int ways;
+    int num_sets;
+    enum TLBPolicy policy;
+    const struct TLBPolicyOps *ops;
+    void *state;          // replacement bookkeeping owned by ops
+    TLBProbeFn probe;     // finds a tag within a set
+    uint64_t *valid;      // bit i is set while entry i holds a translation
+    int32_t *vpn;         // Virtual Page Number
+    int32_t *pfn;         // Page Frame Number
+    int8_t *process_id;   // Process ID associated with the entry (0 to 3, -1 if never used)
+    uint32_t *timestamp;  // timestamp for fifo and lru strategies
+};
+
+static inline int tlb_valid(const struct TLB *tlb, int i)
+{
+    return (tlb->valid[i >> 6] >> (i & 63)) & 1;
+}
+
+// Parse a strategy name (FIFO, LRU, CLOCK, RANDOM, LFU or ARC).
+// Return 0 on success, -1 otherwise.
+int tlb_parse_policy(const char *name, enum TLBPolicy *policy);
+
+// Name of the given strategy, as accepted by tlb_parse_policy.
+const char *tlb_policy_name(enum TLBPolicy policy);
+
+// Allocate a TLB with all entries invalid. ways == 0 means fully associative.
+// Return 0 on success, -1 if the geometry is invalid or allocation fails.
+int tlb_init(struct TLB *tlb, int num_entries, int ways, enum TLBPolicy policy);
+void tlb_free(struct TLB *tlb);
+
+// Write the entries and replacement state to a checkpoint, or read them back
+// into a TLB initialized with the same geometry and strategy.
+// Return 0 on success, -1 on an I/O error or a mismatched checkpoint.
+int tlb_save(struct TLB *tlb, FILE *file);
+int tlb_restore(struct TLB *tlb, FILE *file);
+
+// Choose how tlb_find compares tags. Return 0, or -1 if the CPU lacks support.
+int tlb_set_probe(struct TLB *tlb, enum TLBProbe kind);
+
+// Return the index of the valid entry for (pid, vpn), or -1. No side effects.
+int tlb_find(struct TLB *tlb, int pid, int vpn);
+
+// Translate (pid, vpn). On a hit the replacement state is updated and the
+// entry index is returned; on a miss -1 is returned.
+int tlb_lookup(struct TLB *tlb, int pid, int vpn, uint32_t timestamp);
+
+// Install a translation that is not in the TLB, evicting if the set is full.
+// Return the entry index used; *evicted is set when a valid entry was replaced.
+int tlb_insert(struct TLB *tlb, int pid, int vpn, int pfn, uint32_t timestamp, int *evicted);
+
+// The effect of a map instruction: update the entry for (pid, vpn) if there
+// is one, otherwise insert it. Return the entry index.
+int tlb_map(struct TLB *tlb, int pid, int vpn, int pfn, uint32_t timestamp, int *evicted);
+
+// Invalidate the entry for (pid, vpn), if any. Return its index or -1.
+int tlb_invalidate(struct TLB *tlb, int pid, int vpn);
+
+// Invalidate every entry of process pid. Return the number of entries dropped.
+int tlb_flush(struct TLB *tlb, int pid);
+
+#endif
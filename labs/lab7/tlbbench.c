@@ -0,0 +1,120 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+#include "tlb.h"
+
+// Microbenchmark of the TLB probes: fill a fully associative TLB, then time
+// lookups of resident tags at random entries, and of absent tags, with each
+// probe. Every probe must find the same entries as the scalar one.
+
+#define NUM_LOOKUPS (1 << 20)
+#define NUM_RUNS 7
+
+static double now_seconds()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Best time of several runs, in ns per lookup, to filter out other load on
+// the machine. *checksum is the sum of the returned indices.
+static double time_lookups(struct TLB *tlb, const int *pids, const int *vpns, long *checksum)
+{
+    double best = 0;
+    for (int run = 0; run < NUM_RUNS; run++)
+    {
+        long sum = 0;
+        double start = now_seconds();
+        for (int i = 0; i < NUM_LOOKUPS; i++)
+        {
+            sum += tlb_find(tlb, pids[i], vpns[i]);
+        }
+        double elapsed = now_seconds() - start;
+        if (run == 0 || elapsed < best)
+        {
+            best = elapsed;
+        }
+        *checksum = sum;
+    }
+    return best * 1e9 / NUM_LOOKUPS;
+}
+
+int main(int argc, char *argv[])
+{
+    const int sizes[] = {16, 64, 256, 1024};
+    const enum TLBProbe kinds[] = {PROBE_SCALAR, PROBE_SSE2, PROBE_AVX2};
+    const char *names[] = {"scalar", "sse2", "avx2"};
+    int *pids = malloc(NUM_LOOKUPS * sizeof(int));
+    int *hit_vpns = malloc(NUM_LOOKUPS * sizeof(int));
+    int *miss_vpns = malloc(NUM_LOOKUPS * sizeof(int));
+    int status = 0;
+
+    if (pids == NULL || hit_vpns == NULL || miss_vpns == NULL)
+    {
+        fprintf(stderr, "Error: out of memory\n");
+        return 1;
+    }
+
+    printf("entries,probe,hit_ns,miss_ns,hit_speedup,miss_speedup\n");
+    for (int s = 0; s < (int)(sizeof(sizes) / sizeof(sizes[0])); s++)
+    {
+        struct TLB tlb;
+        int evicted;
+        if (tlb_init(&tlb, sizes[s], 0, POLICY_FIFO) != 0)
+        {
+            fprintf(stderr, "Error: cannot allocate a TLB of %d entries\n", sizes[s]);
+            return 1;
+        }
+        // entry i holds (i % 4, 2 * i), so odd VPNs always miss
+        for (int i = 0; i < sizes[s]; i++)
+        {
+            tlb_insert(&tlb, i % 4, 2 * i, i, i, &evicted);
+        }
+        srand(sizes[s]);
+        for (int i = 0; i < NUM_LOOKUPS; i++)
+        {
+            int e = rand() % sizes[s];
+            pids[i] = e % 4;
+            hit_vpns[i] = 2 * e;
+            miss_vpns[i] = 2 * e + 1;
+        }
+
+        double scalar_hit = 0;
+        double scalar_miss = 0;
+        long expected_hit = 0;
+        long expected_miss = 0;
+        for (int k = 0; k < (int)(sizeof(kinds) / sizeof(kinds[0])); k++)
+        {
+            long hit_sum;
+            long miss_sum;
+            if (tlb_set_probe(&tlb, kinds[k]) != 0)
+            {
+                continue;
+            }
+            double hit = time_lookups(&tlb, pids, hit_vpns, &hit_sum);
+            double miss = time_lookups(&tlb, pids, miss_vpns, &miss_sum);
+
+            if (k == 0)
+            {
+                scalar_hit = hit;
+                scalar_miss = miss;
+                expected_hit = hit_sum;
+                expected_miss = miss_sum;
+            }
+            else if (hit_sum != expected_hit || miss_sum != expected_miss)
+            {
+                fprintf(stderr, "Error: %s probe disagrees with the scalar probe\n", names[k]);
+                status = 1;
+            }
+            printf("%d,%s,%.2f,%.2f,%.2f,%.2f\n", sizes[s], names[k], hit, miss, scalar_hit / hit, scalar_miss / miss);
+        }
+        tlb_free(&tlb);
+    }
+
+    free(pids);
+    free(hit_vpns);
+    free(miss_vpns);
+    return status;
+}
@@ -0,0 +1,747 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include "tlbpolicy.h"
+
+#define TRUE 1
+#define FALSE 0
+
+// Doubly linked list threaded through per-node prev/next arrays. Nodes are
+// TLB entry indices (or ghost node indices for ARC); -1 terminates the list.
+struct List
+{
+    int head;
+    int tail;
+    int size;
+};
+
+static void list_init(struct List *l)
+{
+    l->head = -1;
+    l->tail = -1;
+    l->size = 0;
+}
+
+static void list_push_back(struct List *l, int *prev, int *next, int i)
+{
+    prev[i] = l->tail;
+    next[i] = -1;
+    if (l->tail != -1)
+    {
+        next[l->tail] = i;
+    }
+    else
+    {
+        l->head = i;
+    }
+    l->tail = i;
+    l->size++;
+}
+
+static void list_unlink(struct List *l, int *prev, int *next, int i)
+{
+    if (prev[i] != -1)
+    {
+        next[prev[i]] = next[i];
+    }
+    else
+    {
+        l->head = next[i];
+    }
+    if (next[i] != -1)
+    {
+        prev[next[i]] = prev[i];
+    }
+    else
+    {
+        l->tail = prev[i];
+    }
+    l->size--;
+}
+
+static struct List *alloc_lists(int count)
+{
+    struct List *lists = malloc(count * sizeof(struct List));
+    for (int i = 0; lists != NULL && i < count; i++)
+    {
+        list_init(&lists[i]);
+    }
+    return lists;
+}
+
+// ---------------------------------------------------------------------------
+// FIFO and LRU: one list per set, oldest entry at the head. FIFO appends an
+// entry when it is installed or remapped, LRU when it is installed or hit.
+// This is the same order as the entry timestamps, so victims match the
+// original smallest-timestamp scan.
+
+struct RecencyState
+{
+    int *prev;
+    int *next;
+    struct List *sets;
+};
+
+static int recency_init(struct TLB *tlb)
+{
+    struct RecencyState *s = malloc(sizeof(struct RecencyState));
+    if (s == NULL)
+    {
+        return -1;
+    }
+    s->prev = malloc(tlb->num_entries * sizeof(int));
+    s->next = malloc(tlb->num_entries * sizeof(int));
+    s->sets = alloc_lists(tlb->num_sets);
+    tlb->state = s;
+    return (s->prev && s->next && s->sets) ? 0 : -1;
+}
+
+static void recency_destroy(struct TLB *tlb)
+{
+    struct RecencyState *s = tlb->state;
+    if (s != NULL)
+    {
+        free(s->prev);
+        free(s->next);
+        free(s->sets);
+        free(s);
+    }
+}
+
+static int recency_regions(struct TLB *tlb, struct StateRegion *r)
+{
+    struct RecencyState *s = tlb->state;
+    r[0] = (struct StateRegion){s->prev, tlb->num_entries * sizeof(int)};
+    r[1] = (struct StateRegion){s->next, tlb->num_entries * sizeof(int)};
+    r[2] = (struct StateRegion){s->sets, tlb->num_sets * sizeof(struct List)};
+    return 3;
+}
+
+static int recency_place(struct TLB *tlb, int set, int free_index, int pid, int vpn)
+{
+    struct RecencyState *s = tlb->state;
+    struct List *l = &s->sets[set];
+    int index = free_index;
+    if (index == -1)
+    {
+        index = l->head;
+        list_unlink(l, s->prev, s->next, index);
+    }
+    list_push_back(l, s->prev, s->next, index);
+    return index;
+}
+
+static void recency_touch(struct TLB *tlb, int index)
+{
+    struct RecencyState *s = tlb->state;
+    struct List *l = &s->sets[index / tlb->ways];
+    list_unlink(l, s->prev, s->next, index);
+    list_push_back(l, s->prev, s->next, index);
+}
+
+static void recency_remove(struct TLB *tlb, int index)
+{
+    struct RecencyState *s = tlb->state;
+    list_unlink(&s->sets[index / tlb->ways], s->prev, s->next, index);
+}
+
+static void ignore(struct TLB *tlb, int index)
+{
+}
+
+// ---------------------------------------------------------------------------
+// CLOCK (second chance): a hand per set sweeps the ways, clearing reference
+// bits, and evicts the first entry that has not been used since the last pass.
+
+struct ClockState
+{
+    char *referenced;
+    int *hands;
+};
+
+static int clock_init(struct TLB *tlb)
+{
+    struct ClockState *s = malloc(sizeof(struct ClockState));
+    if (s == NULL)
+    {
+        return -1;
+    }
+    s->referenced = calloc(tlb->num_entries, 1);
+    s->hands = calloc(tlb->num_sets, sizeof(int));
+    tlb->state = s;
+    return (s->referenced && s->hands) ? 0 : -1;
+}
+
+static void clock_destroy(struct TLB *tlb)
+{
+    struct ClockState *s = tlb->state;
+    if (s != NULL)
+    {
+        free(s->referenced);
+        free(s->hands);
+        free(s);
+    }
+}
+
+static int clock_regions(struct TLB *tlb, struct StateRegion *r)
+{
+    struct ClockState *s = tlb->state;
+    r[0] = (struct StateRegion){s->referenced, tlb->num_entries};
+    r[1] = (struct StateRegion){s->hands, tlb->num_sets * sizeof(int)};
+    return 2;
+}
+
+static int clock_place(struct TLB *tlb, int set, int free_index, int pid, int vpn)
+{
+    struct ClockState *s = tlb->state;
+    int index = free_index;
+    if (index == -1)
+    {
+        int base = set * tlb->ways;
+        int hand = s->hands[set];
+        while (s->referenced[base + hand])
+        {
+            s->referenced[base + hand] = 0;
+            hand = (hand + 1) % tlb->ways;
+        }
+        index = base + hand;
+        s->hands[set] = (hand + 1) % tlb->ways;
+    }
+    s->referenced[index] = 1;
+    return index;
+}
+
+static void clock_hit(struct TLB *tlb, int index)
+{
+    struct ClockState *s = tlb->state;
+    s->referenced[index] = 1;
+}
+
+static void clock_remove(struct TLB *tlb, int index)
+{
+    struct ClockState *s = tlb->state;
+    s->referenced[index] = 0;
+}
+
+// ---------------------------------------------------------------------------
+// RANDOM: evict a uniformly chosen way. The generator has a fixed seed so
+// that runs are reproducible.
+
+struct RandomState
+{
+    uint64_t seed;
+};
+
+static int random_init(struct TLB *tlb)
+{
+    struct RandomState *s = malloc(sizeof(struct RandomState));
+    if (s == NULL)
+    {
+        return -1;
+    }
+    s->seed = 0x9E3779B97F4A7C15ULL;
+    tlb->state = s;
+    return 0;
+}
+
+static void random_destroy(struct TLB *tlb)
+{
+    free(tlb->state);
+}
+
+static int random_regions(struct TLB *tlb, struct StateRegion *r)
+{
+    r[0] = (struct StateRegion){tlb->state, sizeof(struct RandomState)};
+    return 1;
+}
+
+static int random_place(struct TLB *tlb, int set, int free_index, int pid, int vpn)
+{
+    struct RandomState *s = tlb->state;
+    if (free_index != -1)
+    {
+        return free_index;
+    }
+    // xorshift64*
+    s->seed ^= s->seed >> 12;
+    s->seed ^= s->seed << 25;
+    s->seed ^= s->seed >> 27;
+    uint64_t r = s->seed * 0x2545F4914F6CDD1DULL;
+    return set * tlb->ways + (int)((r >> 32) % tlb->ways);
+}
+
+// ---------------------------------------------------------------------------
+// LFU in O(1) (Shah, Mitra & Matani): each set keeps a list of frequency
+// buckets in increasing order, and every bucket a list of its entries in the
+// order they reached that frequency. The victim is the oldest entry of the
+// lowest bucket, so ties are broken by LRU.
+
+struct LFUState
+{
+    int *prev;           // per entry, within its bucket
+    int *next;
+    int *bucket;         // per entry
+    int *freq;           // per bucket
+    int *bucket_prev;    // per bucket, within the set
+    int *bucket_next;    // per bucket; also links the free buckets
+    struct List *members; // per bucket
+    int *first;          // per set, lowest-frequency bucket or -1
+    int free_buckets;
+};
+
+static int lfu_init(struct TLB *tlb)
+{
+    struct LFUState *s = malloc(sizeof(struct LFUState));
+    if (s == NULL)
+    {
+        return -1;
+    }
+    // the sets together never use more buckets than there are entries, plus
+    // one while an entry moves up
+    int num_buckets = tlb->num_entries + 1;
+    s->prev = malloc(tlb->num_entries * sizeof(int));
+    s->next = malloc(tlb->num_entries * sizeof(int));
+    s->bucket = malloc(tlb->num_entries * sizeof(int));
+    s->freq = malloc(num_buckets * sizeof(int));
+    s->bucket_prev = malloc(num_buckets * sizeof(int));
+    s->bucket_next = malloc(num_buckets * sizeof(int));
+    s->members = alloc_lists(num_buckets);
+    s->first = malloc(tlb->num_sets * sizeof(int));
+    tlb->state = s;
+    if (!s->prev || !s->next || !s->bucket || !s->freq || !s->bucket_prev || !s->bucket_next || !s->members || !s->first)
+    {
+        return -1;
+    }
+    for (int b = 0; b < num_buckets; b++)
+    {
+        s->bucket_next[b] = b + 1 < num_buckets ? b + 1 : -1;
+    }
+    s->free_buckets = 0;
+    for (int set = 0; set < tlb->num_sets; set++)
+    {
+        s->first[set] = -1;
+    }
+    return 0;
+}
+
+static void lfu_destroy(struct TLB *tlb)
+{
+    struct LFUState *s = tlb->state;
+    if (s != NULL)
+    {
+        free(s->prev);
+        free(s->next);
+        free(s->bucket);
+        free(s->freq);
+        free(s->bucket_prev);
+        free(s->bucket_next);
+        free(s->members);
+        free(s->first);
+        free(s);
+    }
+}
+
+// Create a bucket for freq and link it into the set right after `after`
+// (or at the front when after is -1)
+static int lfu_new_bucket(struct LFUState *s, int set, int after, int freq)
+{
+    int b = s->free_buckets;
+    s->free_buckets = s->bucket_next[b];
+    s->freq[b] = freq;
+    list_init(&s->members[b]);
+
+    int next = after == -1 ? s->first[set] : s->bucket_next[after];
+    s->bucket_prev[b] = after;
+    s->bucket_next[b] = next;
+    if (next != -1)
+    {
+        s->bucket_prev[next] = b;
+    }
+    if (after == -1)
+    {
+        s->first[set] = b;
+    }
+    else
+    {
+        s->bucket_next[after] = b;
+    }
+    return b;
+}
+
+// The blocks of LFU bookkeeping a checkpoint copies
+static int lfu_regions(struct TLB *tlb, struct StateRegion *r)
+{
+    struct LFUState *s = tlb->state;
+    int num_buckets = tlb->num_entries + 1;
+    r[0] = (struct StateRegion){s->prev, tlb->num_entries * sizeof(int)};
+    r[1] = (struct StateRegion){s->next, tlb->num_entries * sizeof(int)};
+    r[2] = (struct StateRegion){s->bucket, tlb->num_entries * sizeof(int)};
+    r[3] = (struct StateRegion){s->freq, num_buckets * sizeof(int)};
+    r[4] = (struct StateRegion){s->bucket_prev, num_buckets * sizeof(int)};
+    r[5] = (struct StateRegion){s->bucket_next, num_buckets * sizeof(int)};
+    r[6] = (struct StateRegion){s->members, num_buckets * sizeof(struct List)};
+    r[7] = (struct StateRegion){s->first, tlb->num_sets * sizeof(int)};
+    r[8] = (struct StateRegion){&s->free_buckets, sizeof(int)};
+    return 9;
+}
+
+// Take an entry out of its bucket, releasing the bucket if it becomes empty
+static void lfu_unlink(struct LFUState *s, int set, int index)
+{
+    int b = s->bucket[index];
+    list_unlink(&s->members[b], s->prev, s->next, index);
+    if (s->members[b].size > 0)
+    {
+        return;
+    }
+
+    if (s->bucket_prev[b] != -1)
+    {
+        s->bucket_next[s->bucket_prev[b]] = s->bucket_next[b];
+    }
+    else
+    {
+        s->first[set] = s->bucket_next[b];
+    }
+    if (s->bucket_next[b] != -1)
+    {
+        s->bucket_prev[s->bucket_next[b]] = s->bucket_prev[b];
+    }
+    s->bucket_next[b] = s->free_buckets;
+    s->free_buckets = b;
+}
+
+static int lfu_place(struct TLB *tlb, int set, int free_index, int pid, int vpn)
+{
+    struct LFUState *s = tlb->state;
+    int index = free_index;
+    if (index == -1)
+    {
+        index = s->members[s->first[set]].head;
+        lfu_unlink(s, set, index);
+    }
+
+    int b = s->first[set];
+    if (b == -1 || s->freq[b] != 1)
+    {
+        b = lfu_new_bucket(s, set, -1, 1);
+    }
+    s->bucket[index] = b;
+    list_push_back(&s->members[b], s->prev, s->next, index);
+    return index;
+}
+
+static void lfu_hit(struct TLB *tlb, int index)
+{
+    struct LFUState *s = tlb->state;
+    int set = index / tlb->ways;
+    int b = s->bucket[index];
+    int next = s->bucket_next[b];
+    if (next == -1 || s->freq[next] != s->freq[b] + 1)
+    {
+        next = lfu_new_bucket(s, set, b, s->freq[b] + 1);
+    }
+    lfu_unlink(s, set, index);
+    s->bucket[index] = next;
+    list_push_back(&s->members[next], s->prev, s->next, index);
+}
+
+static void lfu_remove(struct TLB *tlb, int index)
+{
+    struct LFUState *s = tlb->state;
+    lfu_unlink(s, index / tlb->ways, index);
+}
+
+// ---------------------------------------------------------------------------
+// ARC (Megiddo & Modha): per set, T1 holds entries used once recently and T2
+// entries used at least twice; the ghost lists B1 and B2 remember the
+// (pid, vpn) of entries recently evicted from T1 and T2. A miss that hits a
+// ghost list shifts the target size p of T1 towards the list that would have
+// kept the entry. Ghosts are found through a hash table, so every operation
+// is O(1).
+
+#define ARC_EMPTY (-1)
+
+struct ARCState
+{
+    int *prev; // per entry, within T1 or T2
+    int *next;
+    char *in_t2;
+    struct List *t1; // per set
+    struct List *t2;
+    struct List *b1;
+    struct List *b2;
+    int *p; // per set, target size of T1
+
+    // ghost nodes, at most 2 * ways per set
+    int *ghost_prev;
+    int *ghost_next; // also links the free nodes
+    int *ghost_pid;
+    int *ghost_vpn;
+    char *ghost_in_b2;
+    int free_ghosts;
+
+    // open-addressing hash table from (pid, vpn) to ghost node
+    int *table;
+    int table_mask;
+};
+
+static int arc_init(struct TLB *tlb)
+{
+    struct ARCState *s = malloc(sizeof(struct ARCState));
+    if (s == NULL)
+    {
+        return -1;
+    }
+    int num_ghosts = 2 * tlb->num_entries;
+    int table_size = 1;
+    while (table_size < 2 * num_ghosts)
+    {
+        table_size <<= 1;
+    }
+
+    s->prev = malloc(tlb->num_entries * sizeof(int));
+    s->next = malloc(tlb->num_entries * sizeof(int));
+    s->in_t2 = calloc(tlb->num_entries, 1);
+    s->t1 = alloc_lists(tlb->num_sets);
+    s->t2 = alloc_lists(tlb->num_sets);
+    s->b1 = alloc_lists(tlb->num_sets);
+    s->b2 = alloc_lists(tlb->num_sets);
+    s->p = calloc(tlb->num_sets, sizeof(int));
+    s->ghost_prev = malloc(num_ghosts * sizeof(int));
+    s->ghost_next = malloc(num_ghosts * sizeof(int));
+    s->ghost_pid = malloc(num_ghosts * sizeof(int));
+    s->ghost_vpn = malloc(num_ghosts * sizeof(int));
+    s->ghost_in_b2 = malloc(num_ghosts);
+    s->table = malloc(table_size * sizeof(int));
+    s->table_mask = table_size - 1;
+    tlb->state = s;
+    if (!s->prev || !s->next || !s->in_t2 || !s->t1 || !s->t2 || !s->b1 || !s->b2 || !s->p ||
+        !s->ghost_prev || !s->ghost_next || !s->ghost_pid || !s->ghost_vpn || !s->ghost_in_b2 || !s->table)
+    {
+        return -1;
+    }
+    for (int g = 0; g < num_ghosts; g++)
+    {
+        s->ghost_next[g] = g + 1 < num_ghosts ? g + 1 : -1;
+    }
+    s->free_ghosts = 0;
+    for (int i = 0; i < table_size; i++)
+    {
+        s->table[i] = ARC_EMPTY;
+    }
+    return 0;
+}
+
+static void arc_destroy(struct TLB *tlb)
+{
+    struct ARCState *s = tlb->state;
+    if (s != NULL)
+    {
+        free(s->prev);
+        free(s->next);
+        free(s->in_t2);
+        free(s->t1);
+        free(s->t2);
+        free(s->b1);
+        free(s->b2);
+        free(s->p);
+        free(s->ghost_prev);
+        free(s->ghost_next);
+        free(s->ghost_pid);
+        free(s->ghost_vpn);
+        free(s->ghost_in_b2);
+        free(s->table);
+        free(s);
+    }
+}
+
+static int arc_regions(struct TLB *tlb, struct StateRegion *r)
+{
+    struct ARCState *s = tlb->state;
+    int num_ghosts = 2 * tlb->num_entries;
+    r[0] = (struct StateRegion){s->prev, tlb->num_entries * sizeof(int)};
+    r[1] = (struct StateRegion){s->next, tlb->num_entries * sizeof(int)};
+    r[2] = (struct StateRegion){s->in_t2, tlb->num_entries};
+    r[3] = (struct StateRegion){s->t1, tlb->num_sets * sizeof(struct List)};
+    r[4] = (struct StateRegion){s->t2, tlb->num_sets * sizeof(struct List)};
+    r[5] = (struct StateRegion){s->b1, tlb->num_sets * sizeof(struct List)};
+    r[6] = (struct StateRegion){s->b2, tlb->num_sets * sizeof(struct List)};
+    r[7] = (struct StateRegion){s->p, tlb->num_sets * sizeof(int)};
+    r[8] = (struct StateRegion){s->ghost_prev, num_ghosts * sizeof(int)};
+    r[9] = (struct StateRegion){s->ghost_next, num_ghosts * sizeof(int)};
+    r[10] = (struct StateRegion){s->ghost_pid, num_ghosts * sizeof(int)};
+    r[11] = (struct StateRegion){s->ghost_vpn, num_ghosts * sizeof(int)};
+    r[12] = (struct StateRegion){s->ghost_in_b2, num_ghosts};
+    r[13] = (struct StateRegion){&s->free_ghosts, sizeof(int)};
+    r[14] = (struct StateRegion){s->table, (s->table_mask + 1) * sizeof(int)};
+    return 15;
+}
+
+static int arc_hash(struct ARCState *s, int pid, int vpn)
+{
+    uint64_t key = ((uint64_t)(uint32_t)pid << 32) | (uint32_t)vpn;
+    return (int)(((key * 0x9E3779B97F4A7C15ULL) >> 32) & s->table_mask);
+}
+
+// Return the table slot holding the ghost of (pid, vpn), or -1
+static int arc_find_ghost(struct ARCState *s, int pid, int vpn)
+{
+    for (int slot = arc_hash(s, pid, vpn);; slot = (slot + 1) & s->table_mask)
+    {
+        int g = s->table[slot];
+        if (g == ARC_EMPTY)
+        {
+            return -1;
+        }
+        if (s->ghost_pid[g] == pid && s->ghost_vpn[g] == vpn)
+        {
+            return slot;
+        }
+    }
+}
+
+// Forget a ghost: unlink it from B1 or B2, and delete its table slot with
+// backward shifting so that probe sequences stay unbroken.
+static void arc_drop_ghost(struct ARCState *s, int set, int slot)
+{
+    int g = s->table[slot];
+    struct List *l = s->ghost_in_b2[g] ? &s->b2[set] : &s->b1[set];
+    list_unlink(l, s->ghost_prev, s->ghost_next, g);
+    s->ghost_next[g] = s->free_ghosts;
+    s->free_ghosts = g;
+
+    int hole = slot;
+    for (int i = (slot + 1) & s->table_mask; s->table[i] != ARC_EMPTY; i = (i + 1) & s->table_mask)
+    {
+        int home = arc_hash(s, s->ghost_pid[s->table[i]], s->ghost_vpn[s->table[i]]);
+        // move the entry back if its home is not cyclically within (hole, i]
+        if (((i - home) & s->table_mask) >= ((i - hole) & s->table_mask))
+        {
+            s->table[hole] = s->table[i];
+            hole = i;
+        }
+    }
+    s->table[hole] = ARC_EMPTY;
+}
+
+static void arc_drop_oldest_ghost(struct ARCState *s, int set, struct List *l)
+{
+    int g = l->head;
+    arc_drop_ghost(s, set, arc_find_ghost(s, s->ghost_pid[g], s->ghost_vpn[g]));
+}
+
+// Evict the LRU entry of T1 or T2 into the matching ghost list
+static int arc_replace(struct TLB *tlb, struct ARCState *s, int set, int in_b2)
+{
+    struct List *t1 = &s->t1[set];
+    struct List *t2 = &s->t2[set];
+    int from_t1 = t1->size > 0 && (t1->size > s->p[set] || (in_b2 && t1->size == s->p[set]) || t2->size == 0);
+    struct List *victim_list = from_t1 ? t1 : t2;
+    int victim = victim_list->head;
+    list_unlink(victim_list, s->prev, s->next, victim);
+
+    int g = s->free_ghosts;
+    s->free_ghosts = s->ghost_next[g];
+    s->ghost_pid[g] = tlb->process_id[victim];
+    s->ghost_vpn[g] = tlb->vpn[victim];
+    s->ghost_in_b2[g] = !from_t1;
+    list_push_back(from_t1 ? &s->b1[set] : &s->b2[set], s->ghost_prev, s->ghost_next, g);
+
+    int slot = arc_hash(s, s->ghost_pid[g], s->ghost_vpn[g]);
+    while (s->table[slot] != ARC_EMPTY)
+    {
+        slot = (slot + 1) & s->table_mask;
+    }
+    s->table[slot] = g;
+    return victim;
+}
+
+static int arc_place(struct TLB *tlb, int set, int free_index, int pid, int vpn)
+{
+    struct ARCState *s = tlb->state;
+    struct List *t1 = &s->t1[set];
+    struct List *t2 = &s->t2[set];
+    struct List *b1 = &s->b1[set];
+    struct List *b2 = &s->b2[set];
+    int c = tlb->ways;
+    int index = free_index;
+    int slot = arc_find_ghost(s, pid, vpn);
+    int to_t2 = FALSE;
+    int in_b2 = FALSE;
+
+    if (slot != -1)
+    {
+        // the entry was evicted too early: grow the list it was evicted from
+        in_b2 = s->ghost_in_b2[s->table[slot]];
+        if (!in_b2)
+        {
+            int delta = b1->size >= b2->size ? 1 : b2->size / b1->size;
+            s->p[set] = s->p[set] + delta < c ? s->p[set] + delta : c;
+        }
+        else
+        {
+            int delta = b2->size >= b1->size ? 1 : b1->size / b2->size;
+            s->p[set] = s->p[set] - delta > 0 ? s->p[set] - delta : 0;
+        }
+        arc_drop_ghost(s, set, slot);
+        to_t2 = TRUE;
+    }
+    else if (t1->size + b1->size == c)
+    {
+        if (t1->size < c)
+        {
+            arc_drop_oldest_ghost(s, set, b1);
+        }
+        else
+        {
+            // T1 fills the whole set: drop its LRU entry without a ghost
+            index = t1->head;
+            list_unlink(t1, s->prev, s->next, index);
+        }
+    }
+    else if (t1->size + t2->size + b1->size + b2->size >= 2 * c)
+    {
+        arc_drop_oldest_ghost(s, set, b2);
+    }
+
+    if (index == -1)
+    {
+        index = arc_replace(tlb, s, set, in_b2);
+    }
+
+    s->in_t2[index] = to_t2;
+    list_push_back(to_t2 ? t2 : t1, s->prev, s->next, index);
+    return index;
+}
+
+static void arc_hit(struct TLB *tlb, int index)
+{
+    struct ARCState *s = tlb->state;
+    int set = index / tlb->ways;
+    list_unlink(s->in_t2[index] ? &s->t2[set] : &s->t1[set], s->prev, s->next, index);
+    s->in_t2[index] = TRUE;
+    list_push_back(&s->t2[set], s->prev, s->next, index);
+}
+
+static void arc_remove(struct TLB *tlb, int index)
+{
+    struct ARCState *s = tlb->state;
+    int set = index / tlb->ways;
+    list_unlink(s->in_t2[index] ? &s->t2[set] : &s->t1[set], s->prev, s->next, index);
+}
+
+// ---------------------------------------------------------------------------
+
+static const struct TLBPolicyOps policies[] = {
+    {POLICY_FIFO, "FIFO", recency_init, recency_destroy, recency_place, ignore, recency_touch, recency_remove, recency_regions},
+    {POLICY_LRU, "LRU", recency_init, recency_destroy, recency_place, recency_touch, ignore, recency_remove, recency_regions},
+    {POLICY_CLOCK, "CLOCK", clock_init, clock_destroy, clock_place, clock_hit, ignore, clock_remove, clock_regions},
+    {POLICY_RANDOM, "RANDOM", random_init, random_destroy, random_place, ignore, ignore, ignore, random_regions},
+    {POLICY_LFU, "LFU", lfu_init, lfu_destroy, lfu_place, lfu_hit, ignore, lfu_remove, lfu_regions},
+    {POLICY_ARC, "ARC", arc_init, arc_destroy, arc_place, arc_hit, ignore, arc_remove, arc_regions},
+};
+
+const struct TLBPolicyOps *tlb_policy_ops(enum TLBPolicy policy)
+{
+    return &policies[policy];
+}
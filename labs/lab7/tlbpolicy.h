@@ -0,0 +1,50 @@
+#ifndef __tlbpolicy_h__
+#define __tlbpolicy_h__
+
+#include <stddef.h>
+#include "tlb.h"
+
+// A block of replacement bookkeeping, copied byte for byte by checkpoints
+struct StateRegion
+{
+    void *data;
+    size_t size;
+};
+
+#define TLB_MAX_STATE_REGIONS 16
+
+// A TLB replacement strategy. The TLB owns the entries and calls these hooks
+// as their contents change; each strategy keeps its own bookkeeping in
+// tlb->state so that choosing a victim never has to scan the set.
+struct TLBPolicyOps
+{
+    enum TLBPolicy policy;
+    const char *name;
+
+    // Allocate and release tlb->state. init returns 0 on success, -1 otherwise.
+    int (*init)(struct TLB *tlb);
+    void (*destroy)(struct TLB *tlb);
+
+    // (pid, vpn) is entering the given set. free_index is an invalid entry of
+    // the set, or -1 if the set is full and an entry has to be evicted.
+    // Return the index of the entry that will hold the translation.
+    int (*place)(struct TLB *tlb, int set, int free_index, int pid, int vpn);
+
+    // The entry was used by a translation
+    void (*hit)(struct TLB *tlb, int index);
+
+    // A map instruction rewrote the entry's PFN
+    void (*remap)(struct TLB *tlb, int index);
+
+    // The entry was invalidated
+    void (*remove)(struct TLB *tlb, int index);
+
+    // Describe every block of tlb->state, at most TLB_MAX_STATE_REGIONS, in
+    // a fixed order. Return the number of regions.
+    int (*regions)(struct TLB *tlb, struct StateRegion *regions);
+};
+
+// Return the hooks of a strategy
+const struct TLBPolicyOps *tlb_policy_ops(enum TLBPolicy policy);
+
+#endif
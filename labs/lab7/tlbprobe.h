@@ -0,0 +1,22 @@
+#ifndef __tlbprobe_h__
+#define __tlbprobe_h__
+
+#include "tlb.h"
+
+// Tag comparisons over the ways of a set. Every probe returns the index of
+// the valid entry of [base, base + ways) tagged (pid, vpn), or -1. The vector
+// probes may read up to TLB_PROBE_PAD entries and one bitmap word past the
+// end of the TLB, which tlb_init allocates.
+#define TLB_PROBE_PAD 64
+
+int tlb_probe_scalar(const struct TLB *tlb, int base, int ways, int pid, int vpn);
+#if defined(__x86_64__)
+int tlb_probe_sse2(const struct TLB *tlb, int base, int ways, int pid, int vpn);
+int tlb_probe_avx2(const struct TLB *tlb, int base, int ways, int pid, int vpn);
+#endif
+
+// The probe for a kind, or NULL if the CPU does not support it. PROBE_AUTO
+// picks the fastest supported one.
+TLBProbeFn tlb_probe_select(enum TLBProbe kind);
+
+#endif
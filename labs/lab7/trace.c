@@ -0,0 +1,282 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "trace.h"
+
+#define TRUE 1
+#define FALSE 0
+
+#define RECORD_MARK 0x80
+
+// "ctxswitch" or "tinspect" and three signed 32-bit operands, with a newline
+#define MAX_DECODED_LINE 48
+
+static const char *op_names[NUM_TRACE_OPS] = {"define", "ctxswitch", "map", "unmap", "load", "store",
+                                              "add", "rinspect", "pinspect", "linspect", "tinspect"};
+
+// Numeric operands of each op, not counting those held in the flags
+static int num_operands(enum TraceOp op, int flags)
+{
+    switch (op)
+    {
+    case TRACE_DEFINE:
+        return 3;
+    case TRACE_MAP:
+        return 2;
+    case TRACE_STORE:
+        return (flags & TRACE_IMMEDIATE) ? 2 : 1;
+    case TRACE_ADD:
+    case TRACE_RINSPECT:
+        return 0;
+    default:
+        return 1;
+    }
+}
+
+static int write_varint(FILE *output, int value)
+{
+    // zigzag keeps small negative values short
+    uint32_t bits = ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+    while (bits >= 0x80)
+    {
+        putc((bits & 0x7f) | 0x80, output);
+        bits >>= 7;
+    }
+    return putc(bits, output) == EOF ? -1 : 0;
+}
+
+static int read_varint(FILE *input, int *value)
+{
+    uint32_t bits = 0;
+    for (int shift = 0; shift < 35; shift += 7)
+    {
+        int c = getc(input);
+        if (c == EOF)
+        {
+            return -1;
+        }
+        bits |= (uint32_t)(c & 0x7f) << shift;
+        if (!(c & 0x80))
+        {
+            *value = (int)((bits >> 1) ^ -(bits & 1));
+            return 0;
+        }
+    }
+    return -1;
+}
+
+int trace_write(FILE *output, enum TraceOp op, int flags, int a, int b, int c)
+{
+    int operands[3] = {a, b, c};
+    if (putc(RECORD_MARK | (op << 2) | flags, output) == EOF)
+    {
+        return -1;
+    }
+    for (int i = 0; i < num_operands(op, flags); i++)
+    {
+        if (write_varint(output, operands[i]) != 0)
+        {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// Parse a whole token as an integer, after an optional prefix character
+static int parse_number(const char *token, char prefix, int *value)
+{
+    if (token == NULL || (prefix != '\0' && *token++ != prefix))
+    {
+        return -1;
+    }
+    char *end;
+    long number = strtol(token, &end, 10);
+    if (end == token || *end != '\0')
+    {
+        return -1;
+    }
+    *value = (int)number;
+    return 0;
+}
+
+// Parse r1 or r2 into flags
+static int parse_register(const char *token, int *flags)
+{
+    if (token != NULL && strcmp(token, "r1") == 0)
+    {
+        return 0;
+    }
+    if (token != NULL && strcmp(token, "r2") == 0)
+    {
+        *flags |= TRACE_R2;
+        return 0;
+    }
+    return -1;
+}
+
+int trace_compile_line(const char *line, FILE *output)
+{
+    char buffer[1024];
+    char *tokens[5] = {NULL};
+    char *save;
+    int num_tokens = 0;
+
+    if (line[0] == '%' || strlen(line) >= sizeof(buffer))
+    {
+        return line[0] == '%' ? 0 : -1;
+    }
+    strcpy(buffer, line);
+    for (char *token = strtok_r(buffer, " \r\n", &save); token != NULL && num_tokens < 5; token = strtok_r(NULL, " \r\n", &save))
+    {
+        tokens[num_tokens++] = token;
+    }
+    if (num_tokens == 0)
+    {
+        return 0;
+    }
+
+    int op = 0;
+    while (op < NUM_TRACE_OPS && strcmp(tokens[0], op_names[op]) != 0)
+    {
+        op++;
+    }
+    int flags = 0;
+    int operands[3] = {0, 0, 0};
+    int malformed = FALSE;
+    switch (op)
+    {
+    case TRACE_LOAD:
+        malformed = parse_register(tokens[1], &flags) != 0;
+        if (tokens[2] != NULL && tokens[2][0] == '#')
+        {
+            flags |= TRACE_IMMEDIATE;
+        }
+        malformed |= parse_number(tokens[2], (flags & TRACE_IMMEDIATE) ? '#' : '\0', &operands[0]) != 0;
+        break;
+    case TRACE_STORE:
+        malformed = parse_number(tokens[1], '\0', &operands[0]) != 0;
+        if (tokens[2] != NULL && tokens[2][0] == '#')
+        {
+            flags |= TRACE_IMMEDIATE;
+            malformed |= parse_number(tokens[2], '#', &operands[1]) != 0;
+        }
+        else
+        {
+            malformed |= parse_register(tokens[2], &flags) != 0;
+        }
+        break;
+    case TRACE_RINSPECT:
+        malformed = parse_register(tokens[1], &flags) != 0;
+        break;
+    case NUM_TRACE_OPS:
+        return -1;
+    default:
+        for (int i = 0; i < num_operands(op, flags); i++)
+        {
+            malformed |= parse_number(tokens[i + 1], '\0', &operands[i]) != 0;
+        }
+        break;
+    }
+    if (malformed || trace_write(output, op, flags, operands[0], operands[1], operands[2]) != 0)
+    {
+        return -1;
+    }
+    return 1;
+}
+
+static char *append(char *p, const char *s)
+{
+    while (*s != '\0')
+    {
+        *p++ = *s++;
+    }
+    return p;
+}
+
+static char *append_int(char *p, int value)
+{
+    char digits[12];
+    int n = 0;
+    unsigned int magnitude = value < 0 ? 0u - (unsigned int)value : (unsigned int)value;
+    if (value < 0)
+    {
+        *p++ = '-';
+    }
+    do
+    {
+        digits[n++] = '0' + magnitude % 10;
+        magnitude /= 10;
+    } while (magnitude > 0);
+    while (n > 0)
+    {
+        *p++ = digits[--n];
+    }
+    return p;
+}
+
+char *trace_gets(char *buffer, int size, FILE *input)
+{
+    int c = getc(input);
+    if (c == EOF)
+    {
+        return NULL;
+    }
+    if (!(c & RECORD_MARK))
+    {
+        ungetc(c, input);
+        return fgets(buffer, size, input);
+    }
+
+    int op = (c >> 2) & 0x1f;
+    int flags = c & 3;
+    int operands[3];
+    if (op >= NUM_TRACE_OPS || size < MAX_DECODED_LINE)
+    {
+        return NULL;
+    }
+    for (int i = 0; i < num_operands(op, flags); i++)
+    {
+        if (read_varint(input, &operands[i]) != 0)
+        {
+            return NULL;
+        }
+    }
+
+    // format by hand, snprintf would cost more than the simulation of the line
+    char *p = append(buffer, op_names[op]);
+    int reg = (flags & TRACE_R2) ? '2' : '1';
+    switch (op)
+    {
+    case TRACE_LOAD:
+        p = append(p, " r");
+        *p++ = reg;
+        p = append(p, (flags & TRACE_IMMEDIATE) ? " #" : " ");
+        p = append_int(p, operands[0]);
+        break;
+    case TRACE_STORE:
+        p = append_int(append(p, " "), operands[0]);
+        if (flags & TRACE_IMMEDIATE)
+        {
+            p = append_int(append(p, " #"), operands[1]);
+        }
+        else
+        {
+            p = append(p, " r");
+            *p++ = reg;
+        }
+        break;
+    case TRACE_RINSPECT:
+        p = append(p, " r");
+        *p++ = reg;
+        break;
+    default:
+        for (int i = 0; i < num_operands(op, flags); i++)
+        {
+            p = append_int(append(p, " "), operands[i]);
+        }
+        break;
+    }
+    *p++ = '\n';
+    *p = '\0';
+    return buffer;
+}
@@ -0,0 +1,46 @@
+#ifndef __trace_h__
+#define __trace_h__
+
+#include <stdio.h>
+
+// Compiled traces hold one variable-length record per instruction instead of
+// a line of text: an opcode byte with the high bit set, then the numeric
+// operands as zigzag base-128 varints. A generated load or store takes 3 to
+// 6 bytes instead of 10 to 20. Comments and blank lines are not kept.
+//
+// Text lines never start with a byte above 0x7f, so trace_gets reads either
+// form, and even a mix of both, without being told which one it is given.
+enum TraceOp
+{
+    TRACE_DEFINE,    // off, pfn and vpn bits
+    TRACE_CTXSWITCH, // pid
+    TRACE_MAP,       // vpn, pfn
+    TRACE_UNMAP,     // vpn
+    TRACE_LOAD,      // register in flags, address or immediate
+    TRACE_STORE,     // address, then an immediate or a register in flags
+    TRACE_ADD,
+    TRACE_RINSPECT,  // register in flags
+    TRACE_PINSPECT,  // vpn
+    TRACE_LINSPECT,  // physical location
+    TRACE_TINSPECT,  // TLB entry
+    NUM_TRACE_OPS,
+};
+
+// Flags of a record
+#define TRACE_R2 1        // the register operand is r2 rather than r1
+#define TRACE_IMMEDIATE 2 // the value operand is an immediate, not a register
+
+// Write one record; operands beyond those op takes are ignored.
+// Return 0 on success, -1 on an I/O error.
+int trace_write(FILE *output, enum TraceOp op, int flags, int a, int b, int c);
+
+// Compile one line of a text trace. Return 1 if a record was written, 0 for
+// a comment or blank line, -1 for a malformed instruction or an I/O error.
+int trace_compile_line(const char *line, FILE *output);
+
+// fgets for traces: read the next text line, or decode the next record into
+// its text form with a trailing newline. Return buffer, or NULL at the end of
+// the trace or on a truncated record.
+char *trace_gets(char *buffer, int size, FILE *input);
+
+#endif
@@ -0,0 +1,477 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <getopt.h>
+#include "trace.h"
+#include "writer.h"
+
+#define TRUE 1
+#define FALSE 0
+
+#define MAX_PROCESSES 4
+
+// How each process picks the page of its next reference
+enum Locality
+{
+    LOCALITY_UNIFORM, // any page of the address space
+    LOCALITY_ZIPF,    // page of rank k with probability proportional to 1 / k^s
+    LOCALITY_STRIDE,  // sequential sweep of the address space
+    LOCALITY_PHASE,   // uniform within a block of pages that moves every phase
+    NUM_LOCALITIES,
+};
+
+static const char *locality_names[NUM_LOCALITIES] = {"uniform", "zipf", "stride", "phase"};
+
+struct GeneratorConfig
+{
+    uint64_t references;  // loads and stores to generate
+    int processes;
+    int off_bits;
+    int pfn_bits;
+    int vpn_bits;
+    enum Locality locality;
+    double zipf_exponent;
+    int stride;           // words between consecutive references of LOCALITY_STRIDE
+    uint64_t phase_length; // references per phase of LOCALITY_PHASE
+    int phase_pages;
+    uint64_t switch_interval; // mean references between context switches, 0 for none
+    double store_fraction;
+    uint64_t seed;
+    int compiled;
+};
+
+// Per-process position in its reference stream
+struct ProcessStream
+{
+    int *rank_to_page; // LOCALITY_ZIPF: a random permutation, so processes have different hot pages
+    int cursor;        // LOCALITY_STRIDE: next address
+    int phase_base;    // LOCALITY_PHASE: first page of the current block
+    uint64_t references;
+    char *mapped;      // per VPN, whether a map was emitted
+};
+
+struct Generator
+{
+    struct GeneratorConfig *config;
+    uint64_t rng;
+    int num_pages;
+    int next_frame;
+    double *zipf_cdf; // per rank
+    struct ProcessStream streams[MAX_PROCESSES];
+    struct Writer writer;
+    FILE *output;
+};
+
+// xorshift64*, enough for workloads and much faster than rand()
+static uint64_t next_random(struct Generator *g)
+{
+    g->rng ^= g->rng >> 12;
+    g->rng ^= g->rng << 25;
+    g->rng ^= g->rng >> 27;
+    return g->rng * 0x2545f4914f6cdd1dULL;
+}
+
+// Uniform in [0, n)
+static int random_below(struct Generator *g, int n)
+{
+    return (int)((next_random(g) >> 32) * n >> 32);
+}
+
+// Uniform in [0, 1)
+static double random_unit(struct Generator *g)
+{
+    return (next_random(g) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static void emit(struct Generator *g, enum TraceOp op, int flags, int a, int b, int c)
+{
+    if (g->config->compiled)
+    {
+        trace_write(g->output, op, flags, a, b, c);
+        return;
+    }
+    switch (op)
+    {
+    case TRACE_DEFINE:
+        writer_printf(&g->writer, "define %d %d %d\n", a, b, c);
+        break;
+    case TRACE_CTXSWITCH:
+        writer_printf(&g->writer, "ctxswitch %d\n", a);
+        break;
+    case TRACE_MAP:
+        writer_printf(&g->writer, "map %d %d\n", a, b);
+        break;
+    case TRACE_LOAD:
+        writer_printf(&g->writer, "load r%d %d\n", (flags & TRACE_R2) ? 2 : 1, a);
+        break;
+    case TRACE_STORE:
+        writer_printf(&g->writer, "store %d #%d\n", a, b);
+        break;
+    default:
+        break;
+    }
+}
+
+static int generator_init(struct Generator *g, struct GeneratorConfig *config, FILE *output)
+{
+    memset(g, 0, sizeof(*g));
+    g->config = config;
+    g->output = output;
+    g->rng = config->seed ? config->seed : 1;
+    g->num_pages = 1 << config->vpn_bits;
+    if (!config->compiled && writer_open(&g->writer, output, WRITER_BUFFER_SIZE) != 0)
+    {
+        return -1;
+    }
+
+    if (config->locality == LOCALITY_ZIPF)
+    {
+        g->zipf_cdf = malloc(g->num_pages * sizeof(double));
+        if (g->zipf_cdf == NULL)
+        {
+            return -1;
+        }
+        double sum = 0.0;
+        for (int k = 0; k < g->num_pages; k++)
+        {
+            sum += 1.0 / pow(k + 1, config->zipf_exponent);
+            g->zipf_cdf[k] = sum;
+        }
+        for (int k = 0; k < g->num_pages; k++)
+        {
+            g->zipf_cdf[k] /= sum;
+        }
+    }
+
+    for (int pid = 0; pid < config->processes; pid++)
+    {
+        struct ProcessStream *s = &g->streams[pid];
+        s->mapped = calloc(g->num_pages, 1);
+        if (s->mapped == NULL)
+        {
+            return -1;
+        }
+        if (config->locality == LOCALITY_ZIPF)
+        {
+            s->rank_to_page = malloc(g->num_pages * sizeof(int));
+            if (s->rank_to_page == NULL)
+            {
+                return -1;
+            }
+            for (int k = 0; k < g->num_pages; k++)
+            {
+                s->rank_to_page[k] = k;
+            }
+            for (int k = g->num_pages - 1; k > 0; k--)
+            {
+                int j = random_below(g, k + 1);
+                int page = s->rank_to_page[k];
+                s->rank_to_page[k] = s->rank_to_page[j];
+                s->rank_to_page[j] = page;
+            }
+        }
+        s->cursor = random_below(g, g->num_pages << config->off_bits);
+        s->phase_base = random_below(g, g->num_pages);
+    }
+    return 0;
+}
+
+static void generator_free(struct Generator *g)
+{
+    if (!g->config->compiled)
+    {
+        writer_close(&g->writer);
+    }
+    for (int pid = 0; pid < MAX_PROCESSES; pid++)
+    {
+        free(g->streams[pid].rank_to_page);
+        free(g->streams[pid].mapped);
+    }
+    free(g->zipf_cdf);
+}
+
+// Virtual address of the next reference of process pid
+static int next_address(struct Generator *g, int pid)
+{
+    struct GeneratorConfig *config = g->config;
+    struct ProcessStream *s = &g->streams[pid];
+    int page_words = 1 << config->off_bits;
+    uint64_t index = s->references++;
+    int page;
+
+    switch (config->locality)
+    {
+    case LOCALITY_ZIPF:
+    {
+        // first rank whose cumulative probability reaches u
+        double u = random_unit(g);
+        int low = 0;
+        int high = g->num_pages - 1;
+        while (low < high)
+        {
+            int mid = (low + high) / 2;
+            if (g->zipf_cdf[mid] < u)
+            {
+                low = mid + 1;
+            }
+            else
+            {
+                high = mid;
+            }
+        }
+        page = s->rank_to_page[low];
+        break;
+    }
+    case LOCALITY_STRIDE:
+    {
+        int address = s->cursor;
+        s->cursor = (int)(((int64_t)s->cursor + config->stride) % ((int64_t)g->num_pages * page_words));
+        return address;
+    }
+    case LOCALITY_PHASE:
+        if (index > 0 && index % config->phase_length == 0)
+        {
+            s->phase_base = random_below(g, g->num_pages);
+        }
+        page = (s->phase_base + random_below(g, config->phase_pages)) % g->num_pages;
+        break;
+    default:
+        page = random_below(g, g->num_pages);
+        break;
+    }
+    return page * page_words + random_below(g, page_words);
+}
+
+// Write the whole trace. Every page is mapped, to frames taken round robin,
+// just before its first reference. Write errors are left for ferror.
+static void generate(struct Generator *g)
+{
+    struct GeneratorConfig *config = g->config;
+    int num_frames = 1 << config->pfn_bits;
+    int current = 0;
+
+    if (!config->compiled)
+    {
+        writer_printf(&g->writer, "%% Generated by tracegen: %s locality, %d processes, seed %llu\n",
+                      locality_names[config->locality], config->processes, (unsigned long long)config->seed);
+    }
+    emit(g, TRACE_DEFINE, 0, config->off_bits, config->pfn_bits, config->vpn_bits);
+
+    for (uint64_t i = 0; i < config->references; i++)
+    {
+        if (config->processes > 1 && config->switch_interval > 0 &&
+            random_unit(g) * config->switch_interval < 1.0)
+        {
+            current = (current + 1 + random_below(g, config->processes - 1)) % config->processes;
+            emit(g, TRACE_CTXSWITCH, 0, current, 0, 0);
+        }
+
+        int address = next_address(g, current);
+        int vpn = address >> config->off_bits;
+        if (!g->streams[current].mapped[vpn])
+        {
+            g->streams[current].mapped[vpn] = TRUE;
+            emit(g, TRACE_MAP, 0, vpn, g->next_frame, 0);
+            g->next_frame = (g->next_frame + 1) % num_frames;
+        }
+
+        if (random_unit(g) < config->store_fraction)
+        {
+            emit(g, TRACE_STORE, TRACE_IMMEDIATE, address, random_below(g, 1000), 0);
+        }
+        else
+        {
+            emit(g, TRACE_LOAD, random_below(g, 2) ? TRACE_R2 : 0, address, 0, 0);
+        }
+    }
+}
+
+// Translate a text trace into a compiled one. Return 0 on success, -1 after
+// reporting the first malformed line.
+static int compile_trace(FILE *input, FILE *output)
+{
+    char buffer[1024];
+    int line = 0;
+    while (fgets(buffer, sizeof(buffer), input) != NULL)
+    {
+        line++;
+        if (trace_compile_line(buffer, output) < 0)
+        {
+            fprintf(stderr, "Error: cannot compile line %d: %s", line, buffer);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    const char usage[] = "Usage: tracegen.out [options] <output trace>\n"
+                         "       tracegen.out -C <text trace> <output trace>\n"
+                         "Write a synthetic memsym trace of loads and stores, mapping each page before its first use.\n"
+                         "  -n, --references=N  loads and stores to generate (default 1000000)\n"
+                         "  -P, --processes=N   processes, 1 to 4 (default 4)\n"
+                         "  -o, --off=B         offset bits of define (default 4)\n"
+                         "  -p, --pfn=B         PFN bits of define (default 8)\n"
+                         "  -v, --vpn=B         VPN bits of define, the address space of each process (default 10)\n"
+                         "  -m, --locality=M    uniform (default), zipf, stride or phase\n"
+                         "  -z, --zipf=S        exponent of the zipf locality (default 1.0)\n"
+                         "  -S, --stride=N      words between references of the stride locality (default 1)\n"
+                         "  -l, --phase=N       references per phase of the phase locality (default 10000)\n"
+                         "  -k, --phase-pages=N pages referenced during a phase (default 16)\n"
+                         "  -x, --switch=N      mean references between context switches, 0 for none (default 1000)\n"
+                         "  -w, --stores=F      fraction of references that are stores (default 0.3)\n"
+                         "  -r, --seed=N        random seed (default 1)\n"
+                         "  -c, --compiled      write the compiled form instead of text\n"
+                         "  -C, --compile       compile an existing text trace\n";
+    const struct option long_options[] = {
+        {"references", required_argument, NULL, 'n'},
+        {"processes", required_argument, NULL, 'P'},
+        {"off", required_argument, NULL, 'o'},
+        {"pfn", required_argument, NULL, 'p'},
+        {"vpn", required_argument, NULL, 'v'},
+        {"locality", required_argument, NULL, 'm'},
+        {"zipf", required_argument, NULL, 'z'},
+        {"stride", required_argument, NULL, 'S'},
+        {"phase", required_argument, NULL, 'l'},
+        {"phase-pages", required_argument, NULL, 'k'},
+        {"switch", required_argument, NULL, 'x'},
+        {"stores", required_argument, NULL, 'w'},
+        {"seed", required_argument, NULL, 'r'},
+        {"compiled", no_argument, NULL, 'c'},
+        {"compile", no_argument, NULL, 'C'},
+        {NULL, 0, NULL, 0}};
+    struct GeneratorConfig config = {1000000, 4, 4, 8, 10, LOCALITY_UNIFORM, 1.0, 1, 10000, 16, 1000, 0.3, 1, FALSE};
+    int compile_mode = FALSE;
+    int opt;
+
+    while ((opt = getopt_long(argc, argv, "n:P:o:p:v:m:z:S:l:k:x:w:r:cC", long_options, NULL)) != -1)
+    {
+        switch (opt)
+        {
+        case 'n':
+            config.references = strtoull(optarg, NULL, 10);
+            break;
+        case 'P':
+            config.processes = atoi(optarg);
+            break;
+        case 'o':
+            config.off_bits = atoi(optarg);
+            break;
+        case 'p':
+            config.pfn_bits = atoi(optarg);
+            break;
+        case 'v':
+            config.vpn_bits = atoi(optarg);
+            break;
+        case 'm':
+        {
+            int found = FALSE;
+            for (int i = 0; i < NUM_LOCALITIES; i++)
+            {
+                if (strcmp(optarg, locality_names[i]) == 0)
+                {
+                    config.locality = i;
+                    found = TRUE;
+                }
+            }
+            if (!found)
+            {
+                printf("%s", usage);
+                return 1;
+            }
+            break;
+        }
+        case 'z':
+            config.zipf_exponent = atof(optarg);
+            break;
+        case 'S':
+            config.stride = atoi(optarg);
+            break;
+        case 'l':
+            config.phase_length = strtoull(optarg, NULL, 10);
+            break;
+        case 'k':
+            config.phase_pages = atoi(optarg);
+            break;
+        case 'x':
+            config.switch_interval = strtoull(optarg, NULL, 10);
+            break;
+        case 'w':
+            config.store_fraction = atof(optarg);
+            break;
+        case 'r':
+            config.seed = strtoull(optarg, NULL, 10);
+            break;
+        case 'c':
+            config.compiled = TRUE;
+            break;
+        case 'C':
+            compile_mode = TRUE;
+            break;
+        default:
+            printf("%s", usage);
+            return 1;
+        }
+    }
+
+    // memsym keeps virtual and physical addresses in an int
+    if (argc - optind != (compile_mode ? 2 : 1) ||
+        config.processes < 1 || config.processes > MAX_PROCESSES ||
+        config.off_bits < 0 || config.pfn_bits < 0 || config.vpn_bits < 0 ||
+        config.off_bits + config.pfn_bits > 30 || config.off_bits + config.vpn_bits > 30 ||
+        config.stride < 1 || config.phase_length < 1 || config.phase_pages < 1)
+    {
+        printf("%s", usage);
+        return 1;
+    }
+
+    FILE *input = NULL;
+    if (compile_mode)
+    {
+        input = fopen(argv[optind], "r");
+        if (input == NULL)
+        {
+            fprintf(stderr, "Error: cannot open %s\n", argv[optind]);
+            return 1;
+        }
+    }
+    char *output_trace = argv[argc - 1];
+    FILE *output = fopen(output_trace, "wb");
+    if (output == NULL)
+    {
+        fprintf(stderr, "Error: cannot open %s\n", output_trace);
+        return 1;
+    }
+
+    int status;
+    if (compile_mode)
+    {
+        status = compile_trace(input, output);
+        fclose(input);
+    }
+    else
+    {
+        struct Generator g;
+        status = generator_init(&g, &config, output);
+        if (status != 0)
+        {
+            fprintf(stderr, "Error: out of memory\n");
+        }
+        else
+        {
+            generate(&g);
+        }
+        generator_free(&g);
+    }
+
+    int write_failed = ferror(output);
+    if (fclose(output) != 0 || write_failed)
+    {
+        fprintf(stderr, "Error: cannot write %s\n", output_trace);
+        return 1;
+    }
+    return status == 0 ? 0 : 1;
+}
@@ -0,0 +1,142 @@
+#include <stdlib.h>
+#include <string.h>
+#include "writer.h"
+
+// Longest formatted integer: 20 digits of a 64-bit value plus a sign
+#define MAX_INT_CHARS 21
+
+int writer_open(struct Writer *w, FILE *file, size_t size)
+{
+    w->file = file;
+    w->size = size;
+    w->used = 0;
+    w->buffer = malloc(size);
+    return w->buffer == NULL ? -1 : 0;
+}
+
+void writer_flush(struct Writer *w)
+{
+    if (w->used > 0)
+    {
+        fwrite(w->buffer, 1, w->used, w->file);
+        w->used = 0;
+    }
+}
+
+void writer_close(struct Writer *w)
+{
+    writer_flush(w);
+    fflush(w->file);
+    free(w->buffer);
+    w->buffer = NULL;
+}
+
+static void put_chars(struct Writer *w, const char *s, size_t n)
+{
+    if (w->used + n > w->size)
+    {
+        writer_flush(w);
+        if (n > w->size)
+        {
+            fwrite(s, 1, n, w->file);
+            return;
+        }
+    }
+    memcpy(w->buffer + w->used, s, n);
+    w->used += n;
+}
+
+// Format value into the end of digits, right to left, and return the start
+static char *format_unsigned(unsigned long long value, char *end)
+{
+    do
+    {
+        *--end = '0' + value % 10;
+        value /= 10;
+    } while (value != 0);
+    return end;
+}
+
+static void put_signed(struct Writer *w, long long value)
+{
+    char digits[MAX_INT_CHARS];
+    char *end = digits + sizeof(digits);
+    // negate in unsigned arithmetic so that LLONG_MIN does not overflow
+    unsigned long long magnitude = value < 0 ? 0ULL - (unsigned long long)value : (unsigned long long)value;
+    char *start = format_unsigned(magnitude, end);
+    if (value < 0)
+    {
+        *--start = '-';
+    }
+    put_chars(w, start, end - start);
+}
+
+static void put_unsigned(struct Writer *w, unsigned long long value)
+{
+    char digits[MAX_INT_CHARS];
+    char *end = digits + sizeof(digits);
+    char *start = format_unsigned(value, end);
+    put_chars(w, start, end - start);
+}
+
+void writer_vprintf(struct Writer *w, const char *format, va_list args)
+{
+    const char *p = format;
+    while (*p != '\0')
+    {
+        // copy the literal run up to the next conversion in one go
+        const char *percent = strchr(p, '%');
+        if (percent == NULL)
+        {
+            put_chars(w, p, strlen(p));
+            return;
+        }
+        put_chars(w, p, percent - p);
+        p = percent + 1;
+
+        if (p[0] == 'l' && p[1] == 'l' && p[2] == 'd')
+        {
+            put_signed(w, va_arg(args, long long));
+            p += 3;
+        }
+        else if (p[0] == 'l' && p[1] == 'l' && p[2] == 'u')
+        {
+            put_unsigned(w, va_arg(args, unsigned long long));
+            p += 3;
+        }
+        else if (*p == 'd')
+        {
+            put_signed(w, va_arg(args, int));
+            p++;
+        }
+        else if (*p == 'u')
+        {
+            put_unsigned(w, va_arg(args, unsigned int));
+            p++;
+        }
+        else if (*p == 's')
+        {
+            const char *s = va_arg(args, const char *);
+            put_chars(w, s, strlen(s));
+            p++;
+        }
+        else if (*p == '%')
+        {
+            put_chars(w, "%", 1);
+            p++;
+        }
+        else
+        {
+            // unsupported conversion, print it as is
+            put_chars(w, "%", 1);
+        }
+    }
+}
+
+void writer_printf(struct Writer *w, const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    writer_vprintf(w, format, args);
+    va_end(args);
+}
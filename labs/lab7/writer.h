@@ -0,0 +1,32 @@
+#ifndef __writer_h__
+#define __writer_h__
+
+#include <stdio.h>
+#include <stdarg.h>
+
+// Large-buffer output stream for the simulator log. Formatting is done by
+// hand instead of through fprintf, which dominates the runtime on long traces.
+struct Writer
+{
+    FILE *file;
+    char *buffer;
+    size_t size;
+    size_t used;
+};
+
+#define WRITER_BUFFER_SIZE (1 << 20)
+
+// Return 0 on success, -1 if the buffer cannot be allocated.
+int writer_open(struct Writer *w, FILE *file, size_t size);
+
+// Flush and release the buffer. The file itself is left open.
+void writer_close(struct Writer *w);
+
+void writer_flush(struct Writer *w);
+
+// printf-style output. Only %d, %u, %s, %lld, %llu and %% are understood,
+// without flags, width or precision.
+void writer_printf(struct Writer *w, const char *format, ...);
+void writer_vprintf(struct Writer *w, const char *format, va_list args);
+
+#endif
@@ -0,0 +1,55 @@
+#include <errno.h>
+#include "barrier.h"
+
+#ifdef __APPLE__
+
+int pthread_barrier_init(pthread_barrier_t *barrier, const pthread_barrierattr_t *attr, unsigned int count)
+{
+    if (count == 0)
+    {
+        return EINVAL;
+    }
+    barrier->count = count;
+    barrier->waiting = 0;
+    barrier->generation = 0;
+    if (pthread_mutex_init(&barrier->lock, NULL) != 0)
+    {
+        return EAGAIN;
+    }
+    if (pthread_cond_init(&barrier->all_arrived, NULL) != 0)
+    {
+        pthread_mutex_destroy(&barrier->lock);
+        return EAGAIN;
+    }
+    return 0;
+}
+
+int pthread_barrier_destroy(pthread_barrier_t *barrier)
+{
+    pthread_cond_destroy(&barrier->all_arrived);
+    pthread_mutex_destroy(&barrier->lock);
+    return 0;
+}
+
+int pthread_barrier_wait(pthread_barrier_t *barrier)
+{
+    pthread_mutex_lock(&barrier->lock);
+    unsigned int generation = barrier->generation;
+    if (++barrier->waiting == barrier->count)
+    {
+        // the last thread in releases the others and starts the next round
+        barrier->waiting = 0;
+        barrier->generation++;
+        pthread_cond_broadcast(&barrier->all_arrived);
+        pthread_mutex_unlock(&barrier->lock);
+        return PTHREAD_BARRIER_SERIAL_THREAD;
+    }
+    while (generation == barrier->generation)
+    {
+        pthread_cond_wait(&barrier->all_arrived, &barrier->lock);
+    }
+    pthread_mutex_unlock(&barrier->lock);
+    return 0;
+}
+
+#endif
@@ -0,0 +1,29 @@
+#ifndef __barrier_h__
+#define __barrier_h__
+
+#include <pthread.h>
+
+// macOS ships pthreads without the optional barrier API, so provide the
+// subset used here on top of a mutex and a condition variable.
+#ifdef __APPLE__
+
+#define PTHREAD_BARRIER_SERIAL_THREAD (-1)
+
+typedef struct
+{
+    pthread_mutex_t lock;
+    pthread_cond_t all_arrived;
+    unsigned int count;      // threads to wait for
+    unsigned int waiting;    // threads arrived in the current round
+    unsigned int generation; // rounds completed, tells wakeups from spurious ones
+} pthread_barrier_t;
+
+typedef void pthread_barrierattr_t;
+
+int pthread_barrier_init(pthread_barrier_t *barrier, const pthread_barrierattr_t *attr, unsigned int count);
+int pthread_barrier_destroy(pthread_barrier_t *barrier);
+int pthread_barrier_wait(pthread_barrier_t *barrier);
+
+#endif
+
+#endif
@@ -0,0 +1,842 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include "barrier.h"
+#include "intio.h"
+#include "workers.h"
+
+#define TRUE 1
+#define FALSE 0
+
+#define READ_CHUNK (1 << 20)
+
+// Longest token parse_float_text accepts
+#define MAX_FLOAT_TOKEN 64
+
+#ifndef IOV_MAX
+#define IOV_MAX 1024
+#endif
+
+static int is_space(char c)
+{
+    return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+// Define name(text, length, out, complete), parsing decimal integers of type
+// T. Values are accumulated in the unsigned type U, so out of range values
+// wrap instead of overflowing.
+#define DEFINE_PARSE_INT(name, T, U)                                         \
+    static size_t name(const char *text, size_t length, T *out, int *complete) \
+    {                                                                        \
+        const char *p = text;                                                \
+        const char *end = text + length;                                     \
+        size_t size = 0;                                                     \
+                                                                             \
+        *complete = FALSE;                                                   \
+        while (p < end)                                                      \
+        {                                                                    \
+            if (is_space(*p))                                                \
+            {                                                                \
+                p++;                                                         \
+                continue;                                                    \
+            }                                                                \
+            int negative = *p == '-';                                        \
+            p += negative || *p == '+';                                      \
+            if (p == end || (unsigned char)(*p - '0') > 9)                   \
+            {                                                                \
+                return size;                                                 \
+            }                                                                \
+            U value = 0;                                                     \
+            do                                                               \
+            {                                                                \
+                value = value * 10 + (U)(*p++ - '0');                        \
+            } while (p < end && (unsigned char)(*p - '0') <= 9);             \
+            out[size++] = (T)(negative ? (U)0 - value : value);              \
+        }                                                                    \
+        *complete = TRUE;                                                    \
+        return size;                                                         \
+    }
+
+DEFINE_PARSE_INT(parse_int32_text, int32_t, uint32_t)
+DEFINE_PARSE_INT(parse_int64_text, int64_t, uint64_t)
+
+// Parse floating-point values as strtod does. The text is not terminated,
+// so each token is copied out first.
+static size_t parse_float_text(const char *text, size_t length, enum ScanType type, void *out, int *complete)
+{
+    const char *p = text;
+    const char *end = text + length;
+    size_t size = 0;
+    char token[MAX_FLOAT_TOKEN + 1];
+
+    *complete = FALSE;
+    while (p < end)
+    {
+        if (is_space(*p))
+        {
+            p++;
+            continue;
+        }
+        size_t n = 0;
+        while (p + n < end && !is_space(p[n]) && n <= MAX_FLOAT_TOKEN)
+        {
+            n++;
+        }
+        if (n > MAX_FLOAT_TOKEN)
+        {
+            return size;
+        }
+        memcpy(token, p, n);
+        token[n] = '\0';
+
+        char *stop;
+        double value = strtod(token, &stop);
+        if (stop == token)
+        {
+            return size;
+        }
+        if (type == SCAN_FLOAT)
+        {
+            ((float *)out)[size++] = (float)value;
+        }
+        else
+        {
+            ((double *)out)[size++] = value;
+        }
+
+        // like the integer parsers, stop after a value followed by junk
+        if (stop != token + n)
+        {
+            return size;
+        }
+        p += n;
+    }
+    *complete = TRUE;
+    return size;
+}
+
+int parse_vector_text(const char *text, size_t length, enum ScanType type, void *data, int *complete)
+{
+    switch (type)
+    {
+    case SCAN_INT32:
+        return parse_int32_text(text, length, data, complete);
+    case SCAN_INT64:
+        return parse_int64_text(text, length, data, complete);
+    default:
+        return parse_float_text(text, length, type, data, complete);
+    }
+}
+
+// Room parse_vector_text needs for length bytes: every value takes a digit
+// and a separator, but the last one
+static size_t max_values(size_t length)
+{
+    return (length + 1) / 2 + 1;
+}
+
+// Read the rest of a stream that cannot be mapped, such as a pipe, into a
+// buffer grown geometrically. Return the buffer, or NULL if memory runs out.
+static char *read_all(FILE *file, size_t *length)
+{
+    size_t capacity = READ_CHUNK;
+    size_t used = 0;
+    char *text = malloc(capacity);
+
+    while (text != NULL)
+    {
+        used += fread(text + used, 1, capacity - used, file);
+        if (used < capacity)
+        {
+            break;
+        }
+        capacity *= 2;
+        char *temp = realloc(text, capacity);
+        if (temp == NULL)
+        {
+            free(text);
+            return NULL;
+        }
+        text = temp;
+    }
+    *length = used;
+    return text;
+}
+
+// State shared by the workers of a parallel parse. Each worker parses a
+// range of the text into its own buffer; once all are done, the counts give
+// every range its place in the result, and each worker copies its values
+// there.
+struct ParseShared
+{
+    const char *text;
+    size_t length;
+    enum ScanType type;
+    int numthreads;
+    char **parts;
+    int *counts;
+    int *complete;
+    int *offsets;
+    char *data;
+    int size; // values kept, -1 if memory ran out
+    pthread_barrier_t phase_done;
+};
+
+// Move a split point forward to the start of a token, so no value is cut
+static size_t token_boundary(const char *text, size_t length, size_t i)
+{
+    while (i > 0 && i < length && !is_space(text[i - 1]))
+    {
+        i++;
+    }
+    return i;
+}
+
+static void *parse_worker(void *arg)
+{
+    struct Worker *worker = arg;
+    struct ParseShared *shared = worker->shared;
+    size_t element = scan_type_size(shared->type);
+    int id = worker->id;
+    size_t start;
+    size_t end;
+
+    slice_bounds(shared->length, shared->numthreads, id, &start, &end);
+    start = token_boundary(shared->text, shared->length, start);
+    end = token_boundary(shared->text, shared->length, end);
+    end = end < start ? start : end;
+
+    shared->parts[id] = malloc(max_values(end - start) * element);
+    shared->counts[id] = 0;
+    shared->complete[id] = FALSE;
+    if (shared->parts[id] != NULL)
+    {
+        shared->counts[id] = parse_vector_text(shared->text + start, end - start, shared->type, shared->parts[id], &shared->complete[id]);
+    }
+
+    // one worker places the ranges, up to the first that stopped on a token
+    // that is not a value, as a sequential parse would
+    if (pthread_barrier_wait(&shared->phase_done) == PTHREAD_BARRIER_SERIAL_THREAD)
+    {
+        int total = 0;
+        int failed = FALSE;
+        for (int i = 0; i < shared->numthreads; i++)
+        {
+            shared->offsets[i] = total;
+            total += shared->counts[i];
+            failed |= shared->parts[i] == NULL;
+            if (!shared->complete[i])
+            {
+                for (i++; i < shared->numthreads; i++)
+                {
+                    shared->offsets[i] = -1;
+                }
+            }
+        }
+        shared->data = failed ? NULL : malloc((total + 1) * element);
+        shared->size = shared->data != NULL ? total : -1;
+    }
+    pthread_barrier_wait(&shared->phase_done);
+
+    // each worker fills the slice of the result it will scan, from whichever
+    // ranges hold it, so the pages are first touched where they are used
+    if (shared->data != NULL)
+    {
+        size_t slice_start;
+        size_t slice_end;
+        slice_bounds(shared->size, shared->numthreads, id, &slice_start, &slice_end);
+        for (int i = 0; i < shared->numthreads && shared->offsets[i] >= 0; i++)
+        {
+            size_t offset = shared->offsets[i];
+            size_t from = offset > slice_start ? offset : slice_start;
+            size_t to = offset + shared->counts[i] < slice_end ? offset + shared->counts[i] : slice_end;
+            if (from < to)
+            {
+                memcpy(shared->data + from * element, shared->parts[i] + (from - offset) * element, (to - from) * element);
+            }
+        }
+    }
+
+    // the other workers may still be copying from this range
+    pthread_barrier_wait(&shared->phase_done);
+    free(shared->parts[id]);
+    return NULL;
+}
+
+static int parse_parallel(const char *text, size_t length, enum ScanType type, void **data, int numthreads)
+{
+    struct ParseShared shared;
+    shared.text = text;
+    shared.length = length;
+    shared.type = type;
+    shared.numthreads = numthreads;
+    shared.parts = malloc(numthreads * sizeof(char *));
+    shared.counts = malloc(numthreads * sizeof(int));
+    shared.complete = malloc(numthreads * sizeof(int));
+    shared.offsets = malloc(numthreads * sizeof(int));
+    shared.data = NULL;
+    shared.size = -1;
+    if (shared.parts != NULL && shared.counts != NULL && shared.complete != NULL && shared.offsets != NULL)
+    {
+        pthread_barrier_init(&shared.phase_done, NULL, numthreads);
+        run_workers(parse_worker, &shared, numthreads);
+        pthread_barrier_destroy(&shared.phase_done);
+    }
+    free(shared.parts);
+    free(shared.counts);
+    free(shared.complete);
+    free(shared.offsets);
+    *data = shared.data;
+    return shared.size;
+}
+
+// Load the contents of a file: regular files are mapped, so they are read
+// from the page cache in place, and anything else is read into memory.
+// Return the contents, or NULL if memory runs out.
+static char *load_file(FILE *file, size_t *length, int *mapped)
+{
+    struct stat info;
+    char *text;
+
+    *mapped = FALSE;
+    if (fstat(fileno(file), &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0)
+    {
+        // writable but private, so a vector mapped in place can be scanned
+        // over without touching the file
+        text = mmap(NULL, info.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fileno(file), 0);
+        if (text != MAP_FAILED)
+        {
+            madvise(text, info.st_size, MADV_SEQUENTIAL);
+            *length = info.st_size;
+            *mapped = TRUE;
+            return text;
+        }
+    }
+    return read_all(file, length);
+}
+
+static void unload_file(char *text, size_t length, int mapped)
+{
+    if (mapped)
+    {
+        munmap(text, length);
+    }
+    else
+    {
+        free(text);
+    }
+}
+
+int parse_vector(FILE *file, enum ScanType type, void **data, int numthreads)
+{
+    size_t element = scan_type_size(type);
+    size_t length = 0;
+    int mapped;
+    int size;
+    int complete;
+
+    char *text = load_file(file, &length, &mapped);
+    if (text == NULL)
+    {
+        return -1;
+    }
+
+    if (numthreads > 1)
+    {
+        size = parse_parallel(text, length, type, data, numthreads);
+    }
+    else
+    {
+        *data = malloc(max_values(length) * element);
+        size = *data != NULL ? parse_vector_text(text, length, type, *data, &complete) : -1;
+
+        // give back the room reserved for separators
+        void *temp = size > 0 ? realloc(*data, size * element) : NULL;
+        if (temp != NULL)
+        {
+            *data = temp;
+        }
+    }
+
+    unload_file(text, length, mapped);
+    return size;
+}
+
+int parse_vector_format(const char *name, enum VectorFormat *format)
+{
+    static const char *names[] = {"text", "i32", "i64", "f32", "f64"};
+    for (int i = 0; i < (int)(sizeof(names) / sizeof(names[0])); i++)
+    {
+        if (strcmp(name, names[i]) == 0)
+        {
+            *format = i;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+// Element type of a binary format
+static enum ScanType format_type(enum VectorFormat format)
+{
+    static const enum ScanType types[] = {SCAN_INT32, SCAN_INT32, SCAN_INT64, SCAN_FLOAT, SCAN_DOUBLE};
+    return types[format];
+}
+
+int vector_format_fits(enum VectorFormat format, enum ScanType type)
+{
+    return format == FORMAT_TEXT || scan_type_is_float(format_type(format)) == scan_type_is_float(type);
+}
+
+// Whether a binary format can be read straight into a vector of the type
+static int format_is_native(enum VectorFormat format, enum ScanType type)
+{
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    return format_type(format) == type;
+#else
+    return FALSE;
+#endif
+}
+
+// Decode the little-endian value of the given width at p
+static uint64_t load_le(const unsigned char *p, size_t width)
+{
+    uint64_t bits = 0;
+    for (size_t i = 0; i < width; i++)
+    {
+        bits |= (uint64_t)p[i] << (8 * i);
+    }
+    return bits;
+}
+
+static void store_le(unsigned char *p, uint64_t bits, size_t width)
+{
+    for (size_t i = 0; i < width; i++)
+    {
+        p[i] = (unsigned char)(bits >> (8 * i));
+    }
+}
+
+// Element of an integer format at p, sign-extended
+static int64_t load_int(const unsigned char *p, enum VectorFormat format)
+{
+    return format == FORMAT_INT32 ? (int32_t)load_le(p, 4) : (int64_t)load_le(p, 8);
+}
+
+// Element of a floating-point format at p
+static double load_float(const unsigned char *p, enum VectorFormat format)
+{
+    if (format == FORMAT_FLOAT)
+    {
+        uint32_t bits = load_le(p, 4);
+        float value;
+        memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+    uint64_t bits = load_le(p, 8);
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+static void store_int(unsigned char *p, int64_t value, enum VectorFormat format)
+{
+    store_le(p, (uint64_t)value, format == FORMAT_INT32 ? 4 : 8);
+}
+
+static void store_float(unsigned char *p, double value, enum VectorFormat format)
+{
+    if (format == FORMAT_FLOAT)
+    {
+        float narrow = value;
+        uint32_t bits;
+        memcpy(&bits, &narrow, sizeof(bits));
+        store_le(p, bits, 4);
+        return;
+    }
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    store_le(p, bits, 8);
+}
+
+// Convert count elements of a binary format at bytes to the given type
+static void decode_binary(const unsigned char *bytes, enum VectorFormat format, enum ScanType type, void *data, int count)
+{
+    size_t width = scan_type_size(format_type(format));
+    const unsigned char *p = bytes;
+    for (int i = 0; i < count; i++, p += width)
+    {
+        switch (type)
+        {
+        case SCAN_INT32:
+            // keep the low 32 bits, as text parsing does
+            ((int32_t *)data)[i] = (int32_t)load_int(p, format);
+            break;
+        case SCAN_INT64:
+            ((int64_t *)data)[i] = load_int(p, format);
+            break;
+        case SCAN_FLOAT:
+            ((float *)data)[i] = (float)load_float(p, format);
+            break;
+        default:
+            ((double *)data)[i] = load_float(p, format);
+            break;
+        }
+    }
+}
+
+int read_binary_vector(FILE *file, enum VectorFormat format, enum ScanType type, void **data, int numthreads)
+{
+    size_t width = scan_type_size(format_type(format));
+    size_t length = 0;
+    int mapped;
+
+    char *bytes = load_file(file, &length, &mapped);
+    if (bytes == NULL)
+    {
+        return -1;
+    }
+    if (length / width > INT_MAX)
+    {
+        unload_file(bytes, length, mapped);
+        return -1;
+    }
+    int size = length / width;
+
+    // the file already holds the vector as the host lays it out: scan it in
+    // place, straight from the page cache or the buffer it was read into
+    if (format_is_native(format, type))
+    {
+        *data = bytes;
+        return size;
+    }
+
+    *data = malloc((size + 1) * scan_type_size(type));
+    first_touch(*data, scan_type_size(type), size, numthreads);
+    if (*data != NULL)
+    {
+        decode_binary((const unsigned char *)bytes, format, type, *data, size);
+    }
+    unload_file(bytes, length, mapped);
+    return *data != NULL ? size : -1;
+}
+
+int vector_reader_init(struct VectorReader *reader, FILE *file, enum VectorFormat format, enum ScanType type, int capacity)
+{
+    reader->file = file;
+    reader->format = format;
+    reader->type = type;
+    reader->capacity = capacity < 2 ? 2 : capacity;
+    reader->length = 0;
+    reader->done = FALSE;
+    reader->buffer = NULL;
+    if (format == FORMAT_TEXT)
+    {
+        // the most text that can hold capacity values, see max_values; it
+        // grows only for a token longer than that
+        reader->buffer_size = 2 * (size_t)reader->capacity - 3;
+    }
+    else
+    {
+        reader->buffer_size = format_is_native(format, type) ? 0 : reader->capacity * scan_type_size(format_type(format));
+    }
+    if (reader->buffer_size > 0)
+    {
+        reader->buffer = malloc(reader->buffer_size);
+        if (reader->buffer == NULL)
+        {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+void vector_reader_free(struct VectorReader *reader)
+{
+    free(reader->buffer);
+    reader->buffer = NULL;
+}
+
+// Read the next values of a text stream. The buffer is refilled up to the
+// most text that can hold the capacity, or to the end of the stream, and
+// parsed up to its last whitespace; a token cut by the end of the buffer is
+// kept for the next call.
+static int read_text_block(struct VectorReader *reader, void *data)
+{
+    // the most text that can hold capacity values, see max_values
+    size_t window = 2 * (size_t)reader->capacity - 3;
+    int count = 0;
+
+    while (count == 0 && !reader->done)
+    {
+        size_t length = reader->length;
+        while (length < reader->buffer_size && !feof(reader->file) && !ferror(reader->file))
+        {
+            length += fread(reader->buffer + length, 1, reader->buffer_size - length, reader->file);
+        }
+        if (ferror(reader->file))
+        {
+            return -1;
+        }
+        int at_end = length < reader->buffer_size;
+
+        size_t cut = length < window ? length : window;
+        while ((cut < length || !at_end) && cut > 0 && !is_space(reader->buffer[cut - 1]))
+        {
+            cut--;
+        }
+        if (cut == 0)
+        {
+            // the first token is longer than the window: parse it alone, or
+            // make room for the rest of it
+            while (cut < length && !is_space(reader->buffer[cut]))
+            {
+                cut++;
+            }
+            if (cut == length && !at_end)
+            {
+                char *temp = realloc(reader->buffer, 2 * reader->buffer_size);
+                if (temp == NULL)
+                {
+                    return -1;
+                }
+                reader->buffer = temp;
+                reader->buffer_size *= 2;
+                reader->length = length;
+                continue;
+            }
+        }
+
+        int complete;
+        count = parse_vector_text(reader->buffer, cut, reader->type, data, &complete);
+        memmove(reader->buffer, reader->buffer + cut, length - cut);
+        reader->length = length - cut;
+        reader->done = !complete || (at_end && reader->length == 0);
+    }
+    return count;
+}
+
+int vector_reader_read(struct VectorReader *reader, void *data)
+{
+    if (reader->format == FORMAT_TEXT)
+    {
+        return read_text_block(reader, data);
+    }
+    if (reader->done)
+    {
+        return 0;
+    }
+
+    // read whole elements, straight into data when no conversion is needed
+    size_t width = scan_type_size(format_type(reader->format));
+    void *target = reader->buffer != NULL ? reader->buffer : data;
+    size_t count = fread(target, width, reader->capacity, reader->file);
+    if (count < (size_t)reader->capacity)
+    {
+        if (ferror(reader->file))
+        {
+            return -1;
+        }
+        reader->done = TRUE;
+    }
+    if (reader->buffer != NULL)
+    {
+        decode_binary((const unsigned char *)reader->buffer, reader->format, reader->type, data, count);
+    }
+    return count;
+}
+
+// Define name(p, data, start, end), formatting data[start .. end) of integer
+// type T one per line at p and returning the end of the text
+#define DEFINE_FORMAT_INT(name, T, U)                                      \
+    static char *name(char *p, const T *data, size_t start, size_t end)   \
+    {                                                                      \
+        char digits[24];                                                   \
+        for (size_t i = start; i < end; i++)                               \
+        {                                                                  \
+            T value = data[i];                                             \
+            U magnitude = value < 0 ? (U)0 - (U)value : (U)value;          \
+            int n = 0;                                                     \
+            if (value < 0)                                                 \
+            {                                                              \
+                *p++ = '-';                                                \
+            }                                                              \
+            do                                                             \
+            {                                                              \
+                digits[n++] = '0' + magnitude % 10;                        \
+                magnitude /= 10;                                           \
+            } while (magnitude > 0);                                       \
+            while (n > 0)                                                  \
+            {                                                              \
+                *p++ = digits[--n];                                        \
+            }                                                              \
+            *p++ = '\n';                                                   \
+        }                                                                  \
+        return p;                                                          \
+    }
+
+DEFINE_FORMAT_INT(format_int32, int32_t, uint32_t)
+DEFINE_FORMAT_INT(format_int64, int64_t, uint64_t)
+
+// Longest line written for an element of the given type: a sign, the digits
+// and a newline for integers; enough digits to read back the same value,
+// with a sign, point and exponent, for floating point
+static size_t max_chars(enum ScanType type)
+{
+    static const size_t chars[NUM_SCAN_TYPES] = {12, 21, 18, 26};
+    return chars[type];
+}
+
+// Format data[start .. end) one per line at p. Return the end of the text.
+static char *format_slice(char *p, const void *data, size_t start, size_t end, enum ScanType type)
+{
+    switch (type)
+    {
+    case SCAN_INT32:
+        return format_int32(p, data, start, end);
+    case SCAN_INT64:
+        return format_int64(p, data, start, end);
+    case SCAN_FLOAT:
+        for (size_t i = start; i < end; i++)
+        {
+            p += snprintf(p, max_chars(type) + 1, "%.9g\n", ((const float *)data)[i]);
+        }
+        return p;
+    default:
+        for (size_t i = start; i < end; i++)
+        {
+            p += snprintf(p, max_chars(type) + 1, "%.17g\n", ((const double *)data)[i]);
+        }
+        return p;
+    }
+}
+
+// State shared by the workers of write_vector: each formats its slice into
+// its own buffer, and the buffers are written in order with writev
+struct FormatShared
+{
+    const void *data;
+    int size;
+    enum ScanType type;
+    int numthreads;
+    struct iovec *chunks;
+};
+
+static void *format_worker(void *arg)
+{
+    struct Worker *worker = arg;
+    struct FormatShared *shared = worker->shared;
+    size_t start;
+    size_t end;
+
+    slice_bounds(shared->size, shared->numthreads, worker->id, &start, &end);
+    char *text = malloc((end - start) * max_chars(shared->type) + 1);
+    char *p = text != NULL ? format_slice(text, shared->data, start, end, shared->type) : NULL;
+    shared->chunks[worker->id].iov_base = text;
+    shared->chunks[worker->id].iov_len = text != NULL ? p - text : 0;
+    return NULL;
+}
+
+// Write every chunk to fd, resuming after short writes. Return 0 on success.
+static int write_chunks(int fd, struct iovec *chunks, int count)
+{
+    while (count > 0)
+    {
+        ssize_t written = writev(fd, chunks, count < IOV_MAX ? count : IOV_MAX);
+        if (written < 0)
+        {
+            return -1;
+        }
+        while (count > 0 && (size_t)written >= chunks->iov_len)
+        {
+            written -= chunks->iov_len;
+            chunks++;
+            count--;
+        }
+        if (count > 0)
+        {
+            chunks->iov_base = (char *)chunks->iov_base + written;
+            chunks->iov_len -= written;
+        }
+    }
+    return 0;
+}
+
+int write_vector(FILE *file, const void *data, int size, enum ScanType type, int numthreads)
+{
+    struct FormatShared shared = {data, size, type, numthreads < 1 ? 1 : numthreads, NULL};
+    shared.chunks = calloc(shared.numthreads, sizeof(struct iovec));
+    if (shared.chunks == NULL)
+    {
+        return -1;
+    }
+
+    run_workers(format_worker, &shared, shared.numthreads);
+
+    int status = 0;
+    for (int i = 0; i < shared.numthreads; i++)
+    {
+        // a worker with no buffer ran out of memory
+        status = shared.chunks[i].iov_base == NULL ? -1 : status;
+    }
+    if (status == 0)
+    {
+        // the text goes around the stream's buffer, so empty it first
+        fflush(file);
+        status = write_chunks(fileno(file), shared.chunks, shared.numthreads);
+    }
+    for (int i = 0; i < shared.numthreads; i++)
+    {
+        free(shared.chunks[i].iov_base);
+    }
+    free(shared.chunks);
+    return status;
+}
+
+int write_binary_vector(FILE *file, const void *data, int size, enum ScanType type, enum VectorFormat format)
+{
+    size_t width = scan_type_size(format_type(format));
+
+    if (format_is_native(format, type))
+    {
+        return fwrite(data, width, size, file) == (size_t)size ? 0 : -1;
+    }
+
+    // encode a block at a time, so the output needs no copy of the vector
+    unsigned char block[8 * 4096];
+    size_t per_block = sizeof(block) / width;
+    for (size_t start = 0; start < (size_t)size; start += per_block)
+    {
+        size_t count = (size_t)size - start < per_block ? (size_t)size - start : per_block;
+        for (size_t i = 0; i < count; i++)
+        {
+            unsigned char *p = block + i * width;
+            switch (type)
+            {
+            case SCAN_INT32:
+                store_int(p, ((const int32_t *)data)[start + i], format);
+                break;
+            case SCAN_INT64:
+                store_int(p, ((const int64_t *)data)[start + i], format);
+                break;
+            case SCAN_FLOAT:
+                store_float(p, ((const float *)data)[start + i], format);
+                break;
+            default:
+                store_float(p, ((const double *)data)[start + i], format);
+                break;
+            }
+        }
+        if (fwrite(block, width, count, file) != count)
+        {
+            return -1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,79 @@
+#ifndef __intio_h__
+#define __intio_h__
+
+#include <stdio.h>
+#include "scan.h"
+
+// Encodings of a vector in a file
+enum VectorFormat
+{
+    FORMAT_TEXT,   // decimal, separated by whitespace
+    FORMAT_INT32,  // raw little-endian 32-bit integers
+    FORMAT_INT64,  // raw little-endian 64-bit integers
+    FORMAT_FLOAT,  // raw little-endian IEEE single precision
+    FORMAT_DOUBLE, // raw little-endian IEEE double precision
+};
+
+// Parse a format name (text, i32, i64, f32 or f64).
+// Return 0 on success, -1 otherwise.
+int parse_vector_format(const char *name, enum VectorFormat *format);
+
+// Whether vectors of the given type can be read and written in a format:
+// integer formats hold integer types, floating-point formats hold
+// floating-point types, and text holds any.
+int vector_format_fits(enum VectorFormat format, enum ScanType type);
+
+// Parse a vector of the given type from a file, separated by whitespace, up
+// to the end of the file or the first token that is not a value. With more
+// than one thread, the text is split at whitespace and the pieces parsed in
+// parallel. Return the number of values parsed, or -1 if memory or
+// threads run out.
+int parse_vector(FILE *file, enum ScanType type, void **data, int numthreads);
+
+// Parse the values of text[0 .. length) into data, which must have room for
+// (length + 1) / 2 + 1 of them. Integers wrap when out of range. *complete is
+// set when parsing reached the end of the text rather than a token that is
+// not a value. Return the number parsed.
+int parse_vector_text(const char *text, size_t length, enum ScanType type, void *data, int *complete);
+
+// Read a vector in a binary format, up to the last whole element of the
+// file, converting it to the given type; integers narrowed to 32 bits keep
+// their low bits. When the format matches the type on a little-endian host,
+// nothing is copied: *data points into the file's mapping. Otherwise the
+// pages of the vector are first touched by numthreads workers.
+// Return the number of values read, or -1 if memory runs out.
+int read_binary_vector(FILE *file, enum VectorFormat format, enum ScanType type, void **data, int numthreads);
+
+// Reads a vector from a stream a block at a time, in any format
+struct VectorReader
+{
+    FILE *file;
+    enum VectorFormat format;
+    enum ScanType type;
+    int capacity;       // values per block
+    char *buffer;       // text not yet parsed, or binary to convert
+    size_t buffer_size;
+    size_t length;      // bytes of text held over from the last block
+    int done;
+};
+
+// Prepare to read blocks of up to capacity values of the given type.
+// Return 0 on success, -1 if memory runs out.
+int vector_reader_init(struct VectorReader *reader, FILE *file, enum VectorFormat format, enum ScanType type, int capacity);
+void vector_reader_free(struct VectorReader *reader);
+
+// Read the next block into data, which has room for the capacity. The
+// stream ends as parse_vector and read_binary_vector would end the vector.
+// Return the number of values read, 0 at the end, or -1 on a read error.
+int vector_reader_read(struct VectorReader *reader, void *data);
+
+// Write a vector, one value per line, the slices of each thread formatted in
+// parallel. Floating-point values are written with the digits needed to
+// read them back exactly. Return 0 on success, -1 on an error.
+int write_vector(FILE *file, const void *data, int size, enum ScanType type, int numthreads);
+
+// Write a vector in a binary format, converting it from the given type;
+// integers are sign-extended when widened. Return 0 on success, -1 on an error.
+int write_binary_vector(FILE *file, const void *data, int size, enum ScanType type, enum VectorFormat format);
+
+#endif
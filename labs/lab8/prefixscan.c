@@ -1,102 +1,313 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <pthread.h>
+#include <stdint.h>
+#include <unistd.h>
+#include "scan.h"
+#include "intio.h"
+#include "stream.h"
+#include "workers.h"
 
-// Parse a vector of integers from a file, one per line.
-// Return the number of integers parsed.
-int parse_ints(FILE *file, int **ints)
+#define TRUE 1
+#define FALSE 0
+
+// Read the segment heads of a size-element vector, from a file of flags, one
+// per element and nonzero where a segment starts, or from a file of the
+// indices where segments start. The file is read as 32-bit integers, in the
+// given format if it is an integer one and as text otherwise. Return a flag
+// per element, or NULL after printing why the file is unusable.
+static unsigned char *read_heads(const char *path, int indices, enum VectorFormat format, int size, int numthreads)
 {
+    FILE *file = fopen(path, "r");
+    if (file == NULL)
+    {
+        printf("Cannot open %s\n", path);
+        return NULL;
+    }
 
-    int size = 0;
-    int *buffer = malloc(sizeof(int));
-    int *temp;
+    void *values = NULL;
+    int count;
+    if (format == FORMAT_INT32 || format == FORMAT_INT64)
+    {
+        count = read_binary_vector(file, format, SCAN_INT32, &values, numthreads);
+    }
+    else
+    {
+        count = parse_vector(file, SCAN_INT32, &values, numthreads);
+    }
+    fclose(file);
 
-    while (fscanf(file, "%d", buffer) != EOF)
+    unsigned char *heads = count >= 0 ? calloc(size + 1, 1) : NULL;
+    const int32_t *v = values;
+    if (heads == NULL)
+    {
+        printf("Out of memory reading %s\n", path);
+    }
+    else if (!indices && count < size)
+    {
+        printf("%s has %d flags for %d values\n", path, count, size);
+        free(heads);
+        heads = NULL;
+    }
+    else if (indices)
     {
-        size++;
-        temp = realloc(buffer, size * sizeof(int));
-        if (temp != NULL)
+        for (int i = 0; heads != NULL && i < count; i++)
         {
-            buffer = temp;
+            if (v[i] < 0 || v[i] >= size)
+            {
+                printf("%s has head index %d, out of range for %d values\n", path, v[i], size);
+                free(heads);
+                heads = NULL;
+            }
+            else
+            {
+                heads[v[i]] = TRUE;
+            }
+        }
+    }
+    else
+    {
+        for (int i = 0; i < size; i++)
+        {
+            heads[i] = v[i] != 0;
         }
     }
 
-    *ints = buffer;
-    return size;
+    // a file of 32-bit integers is used in place, from its mapping
+    if (format != FORMAT_INT32)
+    {
+        free(values);
+    }
+    return heads;
 }
 
-// Write a vector of integers to a file, one per line.
-void write_ints(FILE *file, int *ints, int size)
+int main(int argc, char **argv)
 {
+    enum VectorFormat input_format = FORMAT_TEXT;
+    enum VectorFormat output_format = FORMAT_TEXT;
+    enum ScanType type = SCAN_INT32;
+    enum ScanOp op = SCAN_SUM;
+    const char *type_name = "i32";
+    const char *op_name = "sum";
+    const char *heads_path = NULL;
+    int heads_are_indices = FALSE;
+    int block_size = STREAM_DEFAULT_BLOCK;
+    int pin = FALSE;
+    int valid = TRUE;
+    int opt;
 
-    for (int i = 0; i < size; i++)
+    while ((opt = getopt(argc, argv, "i:o:t:p:f:g:b:a")) != -1)
     {
-        fprintf(file, "%d\n", ints[i]);
+        switch (opt)
+        {
+        case 'i':
+            valid &= parse_vector_format(optarg, &input_format) == 0;
+            break;
+        case 'o':
+            valid &= parse_vector_format(optarg, &output_format) == 0;
+            break;
+        case 't':
+            valid &= parse_scan_type(optarg, &type) == 0;
+            type_name = optarg;
+            break;
+        case 'p':
+            valid &= parse_scan_op(optarg, &op) == 0;
+            op_name = optarg;
+            break;
+        case 'f':
+        case 'g':
+            valid &= heads_path == NULL;
+            heads_path = optarg;
+            heads_are_indices = opt == 'g';
+            break;
+        case 'b':
+            block_size = atoi(optarg);
+            valid &= block_size > 0;
+            break;
+        case 'a':
+            pin = TRUE;
+            break;
+        default:
+            valid = FALSE;
+            break;
+        }
     }
-}
 
-// Return the result of a sequential prefix scan of the given vector of integers.
-int *SEQ(int *ints, int size)
-{
-    int *result = malloc(size * sizeof(int));
-    result[0] = ints[0];
-    for (int i = 0; i < size; i++)
+    if (!valid || argc - optind != 4)
     {
-        result[i] = result[i - 1] + ints[i];
+        printf("Usage: %s [options] <mode> <#threads> <input file> <output file>\n", argv[0]);
+        printf("Modes: SEQ, SIMD, HSS, HSP, BLK, LB, SEG, which needs -f or -g, STREAM, and\n");
+        printf("       INPLACE, EXCL (exclusive) and REDUCE (the total only), which need no second vector\n");
+        printf("  -t i32|i64|f32|f64          element type, i32 by default\n");
+        printf("  -p sum|max|min|xor          operator, sum by default\n");
+        printf("  -i text|i32|i64|f32|f64     input format, text by default\n");
+        printf("  -o text|i32|i64|f32|f64     output format, text by default\n");
+        printf("  -f <flags file>             segment flags, nonzero where a segment starts\n");
+        printf("  -g <heads file>             indices where segments start\n");
+        printf("  -b <values>                 block size of STREAM, %d by default\n", STREAM_DEFAULT_BLOCK);
+        printf("  -a                          pin workers to CPUs, spread over sockets\n");
+        return 1;
     }
-    return result;
-}
-
-// Return the result of Hillis/Steele, but with each pass executed sequentially
-int *HSS(int *ints, int size)
-{
-}
 
-// Return the result of Hillis/Steele, parallelized using pthread
-int *HSP(int *ints, int size, int numthreads)
-{
-    return NULL;
-}
+    const struct ScanModes *modes = scan_modes_for(type, op);
+    if (modes == NULL)
+    {
+        printf("Operator %s does not apply to type %s\n", op_name, type_name);
+        return 1;
+    }
+    if (!vector_format_fits(input_format, type) || !vector_format_fits(output_format, type))
+    {
+        printf("Binary formats must be integer for integer types, floating point otherwise\n");
+        return 1;
+    }
 
-int main(int argc, char **argv)
-{
+    if (workers_pin(pin) != 0)
+    {
+        printf("Cannot pin workers to CPUs here\n");
+        return 1;
+    }
 
-    if (argc != 5)
+    char *mode = argv[optind];
+    int num_threads = atoi(argv[optind + 1]);
+    char *input_path = argv[optind + 2];
+    char *output_path = argv[optind + 3];
+    FILE *input = fopen(input_path, "r");
+    if (input == NULL)
     {
-        printf("Usage: %s <mode> <#threads> <input file> <output file>\n", argv[0]);
+        printf("Cannot open %s\n", input_path);
+        return 1;
+    }
+    FILE *output = fopen(output_path, "w");
+    if (output == NULL)
+    {
+        printf("Cannot open %s\n", output_path);
+        fclose(input);
         return 1;
     }
 
-    char *mode = argv[1];
-    int num_threads = atoi(argv[2]);
-    FILE *input = fopen(argv[3], "r");
-    FILE *output = fopen(argv[4], "w");
+    // a stream is scanned as it is read, never held in memory whole
+    if (strcmp(mode, "STREAM") == 0)
+    {
+        struct StreamConfig config = {type, input_format, output_format, modes, block_size, num_threads};
+        if (heads_path != NULL)
+        {
+            printf("Segment heads are given with SEG mode, and only with it\n");
+            return 1;
+        }
+        if (stream_scan(input, output, &config) != 0 || fflush(output) != 0)
+        {
+            printf("Error streaming %s to %s\n", input_path, output_path);
+            return 1;
+        }
+        fclose(input);
+        fclose(output);
+        return 0;
+    }
 
-    int *ints;
+    void *vector;
     int size;
-    size = parse_ints(input, &ints);
+    if (input_format == FORMAT_TEXT)
+    {
+        size = parse_vector(input, type, &vector, num_threads);
+    }
+    else
+    {
+        size = read_binary_vector(input, input_format, type, &vector, num_threads);
+    }
+    if (size < 0)
+    {
+        printf("Out of memory or threads reading %s\n", input_path);
+        return 1;
+    }
 
-    int *result;
+    unsigned char *heads = NULL;
+    if ((heads_path != NULL) != (strcmp(mode, "SEG") == 0))
+    {
+        printf("Segment heads are given with SEG mode, and only with it\n");
+        return 1;
+    }
+    if (heads_path != NULL)
+    {
+        heads = read_heads(heads_path, heads_are_indices, input_format, size, num_threads);
+        if (heads == NULL)
+        {
+            return 1;
+        }
+    }
+
+    union
+    {
+        int64_t i;
+        double d;
+    } total; // room for an element of any type
+    void *result;
     if (strcmp(mode, "SEQ") == 0)
     {
-        result = SEQ(ints, size);
+        result = modes->seq(vector, size);
+    }
+    else if (strcmp(mode, "SIMD") == 0)
+    {
+        result = modes->simd(vector, size);
     }
     else if (strcmp(mode, "HSS") == 0)
     {
-        result = HSS(ints, size);
+        result = modes->hss(vector, size);
     }
     else if (strcmp(mode, "HSP") == 0)
     {
-        result = HSP(ints, size, num_threads);
+        result = modes->hsp(vector, size, num_threads);
+    }
+    else if (strcmp(mode, "BLK") == 0)
+    {
+        result = modes->blk(vector, size, num_threads);
+    }
+    else if (strcmp(mode, "LB") == 0)
+    {
+        result = modes->lb(vector, size, num_threads);
+    }
+    else if (strcmp(mode, "SEG") == 0)
+    {
+        result = modes->seg(vector, heads, size, num_threads);
+    }
+    else if (strcmp(mode, "INPLACE") == 0)
+    {
+        result = modes->inplace(vector, size, num_threads) == 0 ? vector : NULL;
+    }
+    else if (strcmp(mode, "EXCL") == 0)
+    {
+        result = modes->exclusive(vector, size, num_threads) == 0 ? vector : NULL;
+    }
+    else if (strcmp(mode, "REDUCE") == 0)
+    {
+        // the output is the one value the vector reduces to
+        result = modes->reduce(vector, size, num_threads, &total) == 0 ? &total : NULL;
+        size = 1;
     }
     else
     {
         printf("Unknown mode: %s\n", mode);
         return 1;
     }
+    if (result == NULL && size > 0)
+    {
+        printf("Out of memory or threads scanning %s\n", input_path);
+        return 1;
+    }
 
-    write_ints(output, result, size);
+    int status;
+    if (output_format == FORMAT_TEXT)
+    {
+        status = write_vector(output, result, size, type, num_threads);
+    }
+    else
+    {
+        status = write_binary_vector(output, result, size, type, output_format);
+    }
+    if (status != 0 || fflush(output) != 0)
+    {
+        printf("Error writing %s\n", output_path);
+        return 1;
+    }
     fclose(input);
     fclose(output);
     return 0;
@@ -0,0 +1,52 @@
+#include <string.h>
+#include <stdint.h>
+#include "scan.h"
+
+static const char *type_names[NUM_SCAN_TYPES] = {"i32", "i64", "f32", "f64"};
+static const char *op_names[NUM_SCAN_OPS] = {"sum", "max", "min", "xor"};
+
+// Index of name in names, or -1
+static int find_name(const char *name, const char **names, int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        if (strcmp(name, names[i]) == 0)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int parse_scan_type(const char *name, enum ScanType *type)
+{
+    int i = find_name(name, type_names, NUM_SCAN_TYPES);
+    if (i == -1)
+    {
+        return -1;
+    }
+    *type = i;
+    return 0;
+}
+
+int parse_scan_op(const char *name, enum ScanOp *op)
+{
+    int i = find_name(name, op_names, NUM_SCAN_OPS);
+    if (i == -1)
+    {
+        return -1;
+    }
+    *op = i;
+    return 0;
+}
+
+size_t scan_type_size(enum ScanType type)
+{
+    static const size_t sizes[NUM_SCAN_TYPES] = {sizeof(int32_t), sizeof(int64_t), sizeof(float), sizeof(double)};
+    return sizes[type];
+}
+
+int scan_type_is_float(enum ScanType type)
+{
+    return type == SCAN_FLOAT || type == SCAN_DOUBLE;
+}
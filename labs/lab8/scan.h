@@ -0,0 +1,73 @@
+#ifndef __scan_h__
+#define __scan_h__
+
+#include <stddef.h>
+
+// Element types a vector can be scanned as
+enum ScanType
+{
+    SCAN_INT32,
+    SCAN_INT64,
+    SCAN_FLOAT,
+    SCAN_DOUBLE,
+    NUM_SCAN_TYPES,
+};
+
+// Associative operators a vector can be scanned with. Integer sums wrap;
+// xor applies to integers only.
+enum ScanOp
+{
+    SCAN_SUM,
+    SCAN_MAX,
+    SCAN_MIN,
+    SCAN_XOR,
+    NUM_SCAN_OPS,
+};
+
+// The scan modes of prefixscan for one element type and operator. Each
+// returns a newly allocated vector holding the inclusive scan of in, or
+// NULL if memory or threads run out. seg restarts the scan at every i where
+// heads[i] is nonzero. lb is the single-pass decoupled look-back scan.
+//
+// blk_pool returns the state of numthreads workers that scan blocks in
+// place as BLK does, for any number of blocks, or NULL if memory runs out.
+// Every worker calls blk_block with its id and the same block, which
+// continues from the element at carry unless carry is NULL.
+//
+// inplace and exclusive overwrite data with its inclusive or exclusive
+// scan, and reduce stores the combination of all of in at total, each
+// without a second vector. They return 0, or -1 if memory or threads run
+// out.
+struct ScanModes
+{
+    void *(*seq)(const void *in, int size);
+    void *(*simd)(const void *in, int size);
+    void *(*hss)(const void *in, int size);
+    void *(*hsp)(const void *in, int size, int numthreads);
+    void *(*blk)(const void *in, int size, int numthreads);
+    void *(*seg)(const void *in, const unsigned char *heads, int size, int numthreads);
+    void *(*blk_pool)(int numthreads);
+    void (*blk_block)(void *pool, int id, void *data, int size, const void *carry);
+    void (*blk_pool_free)(void *pool);
+    void *(*lb)(const void *in, int size, int numthreads);
+    int (*inplace)(void *data, int size, int numthreads);
+    int (*exclusive)(void *data, int size, int numthreads);
+    int (*reduce)(const void *in, int size, int numthreads, void *total);
+};
+
+// The modes for a type and an operator, or NULL where the operator does not
+// apply to the type. Implemented in scanmodes.c.
+const struct ScanModes *scan_modes_for(enum ScanType type, enum ScanOp op);
+
+// Parse a type name (i32, i64, f32 or f64) or an operator name (sum, max,
+// min or xor). Return 0 on success, -1 otherwise.
+int parse_scan_type(const char *name, enum ScanType *type);
+int parse_scan_op(const char *name, enum ScanOp *op);
+
+// Bytes per element of the given type
+size_t scan_type_size(enum ScanType type);
+
+// Whether the given type holds floating-point values
+int scan_type_is_float(enum ScanType type);
+
+#endif
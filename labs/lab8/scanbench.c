@@ -0,0 +1,394 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include "scan.h"
+#include "workers.h"
+
+#define TRUE 1
+#define FALSE 0
+
+#define DEFAULT_SIZES "1000,10000,100000,1000000,10000000,100000000,1000000000"
+#define DEFAULT_MODES "SEQ,SIMD,HSS,HSP,BLK,LB"
+#define DEFAULT_REPEATS 3
+#define MAX_LIST 64
+
+// Vectors a run holds at once: the input, the SEQ reference, and a result
+// with the second HSP buffer
+#define VECTORS_PER_RUN 4
+
+// Bytes the copy that measures peak bandwidth moves through each buffer
+#define BANDWIDTH_BYTES ((size_t)128 << 20)
+
+static double now(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+// Parse a comma-separated list of positive integers. Return the number of
+// values parsed, or -1 on a malformed list.
+static int parse_long_list(const char *list, long *values)
+{
+    int count = 0;
+    const char *p = list;
+    while (*p != '\0')
+    {
+        char *end;
+        long value = strtol(p, &end, 10);
+        if (end == p || value <= 0 || count == MAX_LIST || (*end != ',' && *end != '\0'))
+        {
+            return -1;
+        }
+        values[count++] = value;
+        p = (*end == ',') ? end + 1 : end;
+    }
+    return count;
+}
+
+// Split a comma-separated list of modes in buffer, which it is copied into
+// and which the names point into. Return the number of modes, or -1 on an
+// unknown mode.
+static int parse_mode_list(const char *list, char *buffer, size_t capacity, const char **modes)
+{
+    int count = 0;
+
+    if (strlen(list) >= capacity)
+    {
+        return -1;
+    }
+    strcpy(buffer, list);
+    for (char *name = strtok(buffer, ","); name != NULL; name = strtok(NULL, ","))
+    {
+        if (count == MAX_LIST || (strcmp(name, "SEQ") != 0 && strcmp(name, "SIMD") != 0 && strcmp(name, "HSS") != 0 &&
+                                  strcmp(name, "HSP") != 0 && strcmp(name, "BLK") != 0 && strcmp(name, "LB") != 0))
+        {
+            return -1;
+        }
+        modes[count++] = name;
+    }
+    return count;
+}
+
+// Whether a mode uses a thread count
+static int is_parallel(const char *mode)
+{
+    return strcmp(mode, "HSP") == 0 || strcmp(mode, "BLK") == 0 || strcmp(mode, "LB") == 0;
+}
+
+static void *run_mode(const struct ScanModes *modes, const char *mode, const void *in, int size, int numthreads)
+{
+    if (strcmp(mode, "SEQ") == 0)
+    {
+        return modes->seq(in, size);
+    }
+    if (strcmp(mode, "SIMD") == 0)
+    {
+        return modes->simd(in, size);
+    }
+    if (strcmp(mode, "HSS") == 0)
+    {
+        return modes->hss(in, size);
+    }
+    if (strcmp(mode, "HSP") == 0)
+    {
+        return modes->hsp(in, size, numthreads);
+    }
+    if (strcmp(mode, "BLK") == 0)
+    {
+        return modes->blk(in, size, numthreads);
+    }
+    return modes->lb(in, size, numthreads);
+}
+
+// Fastest of repeats runs of a mode, in seconds. The result of the last run
+// is left in *result.
+static double time_mode(const struct ScanModes *modes, const char *mode, const void *in, int size, int numthreads, int repeats, void **result)
+{
+    double best = INFINITY;
+    *result = NULL;
+    for (int r = 0; r < repeats; r++)
+    {
+        free(*result);
+        double start = now();
+        *result = run_mode(modes, mode, in, size, numthreads);
+        double elapsed = now() - start;
+        best = elapsed < best ? elapsed : best;
+    }
+    return best;
+}
+
+// Fill a vector with small pseudo-random values; floating-point values are
+// multiples of 0.5, so sums stay exact for as long as the precision allows
+static void fill_input(void *in, enum ScanType type, int size)
+{
+    uint32_t x = 2463534242u;
+    for (int i = 0; i < size; i++)
+    {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        int value = (int)(x % 101) - 50;
+        switch (type)
+        {
+        case SCAN_INT32:
+            ((int32_t *)in)[i] = value;
+            break;
+        case SCAN_INT64:
+            ((int64_t *)in)[i] = value;
+            break;
+        case SCAN_FLOAT:
+            ((float *)in)[i] = value * 0.5f;
+            break;
+        default:
+            ((double *)in)[i] = value * 0.5;
+            break;
+        }
+    }
+}
+
+// Whether a result matches the SEQ reference: exactly for integers, and for
+// floating point within a rounding error that grows with the size, since
+// the parallel modes combine in a different order
+static int matches(const void *result, const void *reference, enum ScanType type, int size)
+{
+    if (!scan_type_is_float(type))
+    {
+        return memcmp(result, reference, size * scan_type_size(type)) == 0;
+    }
+    double epsilon = (type == SCAN_FLOAT ? 1e-6 : 1e-15) * log2(size + 2) * 4;
+    for (int i = 0; i < size; i++)
+    {
+        double a = type == SCAN_FLOAT ? ((const float *)result)[i] : ((const double *)result)[i];
+        double b = type == SCAN_FLOAT ? ((const float *)reference)[i] : ((const double *)reference)[i];
+        if (fabs(a - b) > epsilon * fmax(1.0, fabs(b)) && !(isnan(a) && isnan(b)))
+        {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+// State shared by the workers of measure_bandwidth
+struct CopyShared
+{
+    char *src;
+    char *dst;
+    size_t bytes;
+    int numthreads;
+};
+
+static void *copy_worker(void *arg)
+{
+    struct Worker *worker = arg;
+    struct CopyShared *shared = worker->shared;
+    size_t start;
+    size_t end;
+    slice_bounds(shared->bytes, shared->numthreads, worker->id, &start, &end);
+    memcpy(shared->dst + start, shared->src + start, end - start);
+    return NULL;
+}
+
+// Peak memory bandwidth in bytes per second, as the fastest parallel copy
+// of a buffer larger than the caches, counting the bytes read and written
+static double measure_bandwidth(int numthreads, size_t bytes)
+{
+    struct CopyShared shared = {malloc(bytes), malloc(bytes), bytes, numthreads};
+    double best = INFINITY;
+    if (shared.src != NULL && shared.dst != NULL)
+    {
+        first_touch(shared.src, 1, bytes, numthreads);
+        first_touch(shared.dst, 1, bytes, numthreads);
+        memset(shared.src, 1, bytes);
+        for (int r = 0; r < DEFAULT_REPEATS; r++)
+        {
+            double start = now();
+            run_workers(copy_worker, &shared, numthreads);
+            double elapsed = now() - start;
+            best = elapsed < best ? elapsed : best;
+        }
+    }
+    free(shared.src);
+    free(shared.dst);
+    return best < INFINITY ? 2.0 * bytes / best : 0.0;
+}
+
+static void usage(const char *program)
+{
+    printf("Usage: %s [options]\n", program);
+    printf("Times the scan modes alone, without I/O, and writes one CSV row per run.\n");
+    printf("  -t i32|i64|f32|f64   element type, i32 by default\n");
+    printf("  -p sum|max|min|xor   operator, sum by default\n");
+    printf("  -m <modes>           modes to time, %s by default\n", DEFAULT_MODES);
+    printf("  -n <sizes>           vector sizes, %s by default\n", DEFAULT_SIZES);
+    printf("  -T <threads>         thread counts, powers of two up to the cores and the cores by default\n");
+    printf("  -r <repeats>         runs per measurement, the fastest is kept, %d by default\n", DEFAULT_REPEATS);
+    printf("  -o <file>            CSV output, stdout by default\n");
+    printf("  -a                   pin workers to CPUs, spread over sockets\n");
+}
+
+int main(int argc, char **argv)
+{
+    enum ScanType type = SCAN_INT32;
+    enum ScanOp op = SCAN_SUM;
+    const char *type_name = "i32";
+    const char *op_name = "sum";
+    const char *mode_list = DEFAULT_MODES;
+    const char *size_list = DEFAULT_SIZES;
+    const char *thread_list = NULL;
+    const char *output_path = NULL;
+    int repeats = DEFAULT_REPEATS;
+    int pin = FALSE;
+    int valid = TRUE;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "t:p:m:n:T:r:o:a")) != -1)
+    {
+        switch (opt)
+        {
+        case 't':
+            valid &= parse_scan_type(optarg, &type) == 0;
+            type_name = optarg;
+            break;
+        case 'p':
+            valid &= parse_scan_op(optarg, &op) == 0;
+            op_name = optarg;
+            break;
+        case 'm':
+            mode_list = optarg;
+            break;
+        case 'n':
+            size_list = optarg;
+            break;
+        case 'T':
+            thread_list = optarg;
+            break;
+        case 'r':
+            repeats = atoi(optarg);
+            valid &= repeats > 0;
+            break;
+        case 'o':
+            output_path = optarg;
+            break;
+        case 'a':
+            pin = TRUE;
+            break;
+        default:
+            valid = FALSE;
+            break;
+        }
+    }
+
+    char mode_buffer[256];
+    const char *modes_to_run[MAX_LIST];
+    long sizes[MAX_LIST];
+    long threads[MAX_LIST];
+    int num_modes = parse_mode_list(mode_list, mode_buffer, sizeof(mode_buffer), modes_to_run);
+    int num_sizes = parse_long_list(size_list, sizes);
+    int num_threads = 0;
+    int cores = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    cores = cores > 0 ? cores : 1;
+    if (thread_list != NULL)
+    {
+        num_threads = parse_long_list(thread_list, threads);
+    }
+    else
+    {
+        for (long t = 1; t < cores && num_threads < MAX_LIST - 1; t *= 2)
+        {
+            threads[num_threads++] = t;
+        }
+        threads[num_threads++] = cores;
+    }
+
+    if (!valid || optind != argc || num_modes <= 0 || num_sizes <= 0 || num_threads <= 0)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+    const struct ScanModes *modes = scan_modes_for(type, op);
+    if (modes == NULL)
+    {
+        printf("Operator %s does not apply to type %s\n", op_name, type_name);
+        return 1;
+    }
+    if (workers_pin(pin) != 0)
+    {
+        printf("Cannot pin workers to CPUs here\n");
+        return 1;
+    }
+    FILE *output = output_path != NULL ? fopen(output_path, "w") : stdout;
+    if (output == NULL)
+    {
+        printf("Cannot open %s\n", output_path);
+        return 1;
+    }
+
+    // sizes are skipped once their vectors would take more than half the memory
+    size_t element = scan_type_size(type);
+    double memory = (double)sysconf(_SC_PHYS_PAGES) * sysconf(_SC_PAGESIZE);
+    size_t copy_bytes = BANDWIDTH_BYTES < memory / 8 ? BANDWIDTH_BYTES : (size_t)(memory / 8);
+    double peak = measure_bandwidth(cores, copy_bytes);
+    fprintf(stderr, "Peak copy bandwidth: %.2f GB/s\n", peak / 1e9);
+
+    fprintf(output, "type,op,mode,threads,elements,seconds,elements_per_sec,speedup,efficiency,bandwidth_gbs,bandwidth_util,verified\n");
+    for (int s = 0; s < num_sizes; s++)
+    {
+        long size = sizes[s];
+        if (size > INT32_MAX || (double)size * element * VECTORS_PER_RUN > memory / 2)
+        {
+            fprintf(stderr, "Skipping %ld elements: too large for this host\n", size);
+            continue;
+        }
+
+        void *in = malloc(size * element);
+        if (in == NULL)
+        {
+            fprintf(stderr, "Skipping %ld elements: out of memory\n", size);
+            continue;
+        }
+        first_touch(in, element, size, cores);
+        fill_input(in, type, size);
+
+        // every mode is compared with, and its speedup taken over, SEQ
+        void *reference;
+        double baseline = time_mode(modes, "SEQ", in, size, 1, repeats, &reference);
+
+        for (int m = 0; m < num_modes; m++)
+        {
+            const char *mode = modes_to_run[m];
+            for (int t = 0; t < (is_parallel(mode) ? num_threads : 1); t++)
+            {
+                int numthreads = is_parallel(mode) ? threads[t] : 1;
+                void *result;
+                double seconds = strcmp(mode, "SEQ") == 0 ? baseline : time_mode(modes, mode, in, size, numthreads, repeats, &result);
+                int verified = strcmp(mode, "SEQ") == 0 || (result != NULL && matches(result, reference, type, size));
+                if (strcmp(mode, "SEQ") != 0)
+                {
+                    free(result);
+                }
+
+                // the least traffic a scan needs: read the input, write the result
+                double bandwidth = 2.0 * size * element / seconds;
+                double speedup = baseline / seconds;
+                fprintf(output, "%s,%s,%s,%d,%ld,%.9f,%.6g,%.4f,%.4f,%.4f,%.4f,%s\n",
+                        type_name, op_name, mode, numthreads, size, seconds,
+                        size / seconds, speedup, speedup / numthreads, bandwidth / 1e9,
+                        peak > 0 ? bandwidth / peak : 0.0, verified ? "yes" : "no");
+                fflush(output);
+            }
+        }
+        free(reference);
+        free(in);
+    }
+
+    if (output != stdout)
+    {
+        fclose(output);
+    }
+    return 0;
+}
@@ -0,0 +1,665 @@
+// The scan modes for one element type and operator. This file is included
+// once per combination by scanops.h, with these defined:
+//
+//   SCAN_TYPE, SCAN_OP   name suffixes, e.g. i32 and sum
+//   SCAN_T               the element type
+//   SCAN_COMBINE(a, b)   the operator
+//   SCAN_IDENTITY        x such that SCAN_COMBINE(x, a) == a
+//   SCAN_KERNEL          optional, a ScanKernel to use for SIMD
+//
+// Every function gets the suffix _<type>_<op>, so each loop is compiled
+// with the operator inlined, and the modes are collected in
+// modes_<type>_<op>. SCAN_OP, SCAN_COMBINE, SCAN_IDENTITY and SCAN_KERNEL
+// are undefined at the end.
+
+#ifndef SCAN_NAME
+#define SCAN_PASTE(name, type, op) name##_##type##_##op
+#define SCAN_EXPAND(name, type, op) SCAN_PASTE(name, type, op)
+#define SCAN_NAME(name) SCAN_EXPAND(name, SCAN_TYPE, SCAN_OP)
+
+// Elements per chunk of LB, few enough for a chunk to stay in cache between
+// its reduction and its scan
+#define LB_CHUNK 8192
+
+// How far a chunk of LB has got: nothing published yet, its own total, or
+// the combination of everything up to and including it
+enum LBStatus
+{
+    LB_EMPTY,
+    LB_AGGREGATE,
+    LB_PREFIX,
+};
+#endif
+
+// Inclusive scan of in[0 .. size) into out, starting from carry. Return the
+// last result, carry for a following block. in and out may alias.
+static SCAN_T SCAN_NAME(scan_block)(const SCAN_T *in, SCAN_T *out, size_t size, SCAN_T carry)
+{
+    for (size_t i = 0; i < size; i++)
+    {
+        carry = SCAN_COMBINE(carry, in[i]);
+        out[i] = carry;
+    }
+    return carry;
+}
+
+// Return the result of a sequential prefix scan of the given vector
+static void *SCAN_NAME(SEQ)(const void *in, int size)
+{
+    const SCAN_T *ints = in;
+    SCAN_T *result = malloc(size * sizeof(SCAN_T));
+    for (int i = 0; i < size; i++)
+    {
+        result[i] = i > 0 ? SCAN_COMBINE(result[i - 1], ints[i]) : ints[i];
+    }
+    return result;
+}
+
+// Return the result of a sequential scan by the widest SIMD kernel the CPU
+// supports, or by a scalar loop where there is none
+static void *SCAN_NAME(SIMD)(const void *in, int size)
+{
+    SCAN_T *result = malloc(size * sizeof(SCAN_T));
+    if (result == NULL && size > 0)
+    {
+        return NULL;
+    }
+#ifdef SCAN_KERNEL
+    SCAN_KERNEL(in, result, size, SCAN_IDENTITY);
+#else
+    SCAN_NAME(scan_block)(in, result, size, SCAN_IDENTITY);
+#endif
+    return result;
+}
+
+// One Hillis/Steele pass over [start, end): every element combines with the
+// one offset positions before it, reading from src and writing to dst.
+static void SCAN_NAME(hs_pass)(const SCAN_T *src, SCAN_T *dst, size_t start, size_t end, size_t offset)
+{
+    for (size_t i = start; i < end; i++)
+    {
+        dst[i] = i >= offset ? SCAN_COMBINE(src[i - offset], src[i]) : src[i];
+    }
+}
+
+// Return the result of Hillis/Steele, but with each pass executed sequentially
+static void *SCAN_NAME(HSS)(const void *in, int size)
+{
+    SCAN_T *src = malloc(size * sizeof(SCAN_T));
+    SCAN_T *dst = malloc(size * sizeof(SCAN_T));
+    SCAN_T *temp;
+
+    if ((src == NULL || dst == NULL) && size > 0)
+    {
+        free(src);
+        free(dst);
+        return NULL;
+    }
+    memcpy(src, in, size * sizeof(SCAN_T));
+    for (int offset = 1; offset < size; offset *= 2)
+    {
+        SCAN_NAME(hs_pass)(src, dst, 0, size, offset);
+        temp = src;
+        src = dst;
+        dst = temp;
+    }
+    free(dst);
+    return src;
+}
+
+// State shared by the workers of HSP. Both buffers are swapped after every
+// pass, by every worker in the same way, so no worker needs to publish them.
+struct SCAN_NAME(HSPShared)
+{
+    SCAN_T *buffers[2];
+    int size;
+    int numthreads;
+    pthread_barrier_t pass_done;
+};
+
+static void *SCAN_NAME(hsp_worker)(void *arg)
+{
+    struct Worker *worker = arg;
+    struct SCAN_NAME(HSPShared) *shared = worker->shared;
+    size_t start;
+    size_t end;
+    int current = 0;
+
+    // each worker owns the same slice of the vector for every pass
+    slice_bounds(shared->size, shared->numthreads, worker->id, &start, &end);
+
+    for (int offset = 1; offset < shared->size; offset *= 2)
+    {
+        SCAN_NAME(hs_pass)(shared->buffers[current], shared->buffers[1 - current], start, end, offset);
+        current = 1 - current;
+
+        // the next pass reads neighbours' results
+        pthread_barrier_wait(&shared->pass_done);
+    }
+    return NULL;
+}
+
+// Return the result of Hillis/Steele, parallelized using pthread
+static void *SCAN_NAME(HSP)(const void *in, int size, int numthreads)
+{
+    if (numthreads < 1)
+    {
+        numthreads = 1;
+    }
+
+    struct SCAN_NAME(HSPShared) shared;
+    shared.buffers[0] = malloc(size * sizeof(SCAN_T));
+    shared.buffers[1] = malloc(size * sizeof(SCAN_T));
+    if ((shared.buffers[0] == NULL || shared.buffers[1] == NULL) && size > 0)
+    {
+        free(shared.buffers[0]);
+        free(shared.buffers[1]);
+        return NULL;
+    }
+    shared.size = size;
+    shared.numthreads = numthreads;
+    first_touch(shared.buffers[0], sizeof(SCAN_T), size, numthreads);
+    first_touch(shared.buffers[1], sizeof(SCAN_T), size, numthreads);
+    memcpy(shared.buffers[0], in, size * sizeof(SCAN_T));
+    pthread_barrier_init(&shared.pass_done, NULL, numthreads);
+
+    // the workers live for the whole scan
+    if (run_workers(SCAN_NAME(hsp_worker), &shared, numthreads) != 0)
+    {
+        free(shared.buffers[0]);
+        free(shared.buffers[1]);
+        pthread_barrier_destroy(&shared.pass_done);
+        return NULL;
+    }
+
+    // after an odd number of passes the result is in the second buffer
+    int passes = 0;
+    for (int offset = 1; offset < size; offset *= 2)
+    {
+        passes++;
+    }
+    SCAN_T *result = shared.buffers[passes % 2];
+    free(shared.buffers[1 - passes % 2]);
+    pthread_barrier_destroy(&shared.pass_done);
+    return result;
+}
+
+// Workers scanning one block after another as BLK does, all of them
+// calling blk_phases with the same block. They can live for a whole stream.
+struct SCAN_NAME(BLKPool)
+{
+    SCAN_T *totals; // per worker, the scan of its slice, then of the slices before it
+    int numthreads;
+    pthread_barrier_t phase_done;
+};
+
+// Scan worker id's slice of in into out, which may alias, as part of a
+// work-efficient blocked scan of the pool: each worker scans its slice, the
+// slice totals are scanned, and each worker combines its slice with its
+// offset. When carry is not NULL, the scan continues from *carry.
+static void SCAN_NAME(blk_phases)(struct SCAN_NAME(BLKPool) *pool, int id, const SCAN_T *in, SCAN_T *out, int size, const SCAN_T *carry)
+{
+    size_t start;
+    size_t end;
+
+    slice_bounds(size, pool->numthreads, id, &start, &end);
+
+    // phase 1: scan the slice on its own
+    pool->totals[id] = SCAN_NAME(scan_block)(in + start, out + start, end - start, SCAN_IDENTITY);
+
+    // phase 2: one worker turns the slice totals into exclusive offsets
+    if (pthread_barrier_wait(&pool->phase_done) == PTHREAD_BARRIER_SERIAL_THREAD)
+    {
+        SCAN_T offset = carry != NULL ? *carry : SCAN_IDENTITY;
+        for (int i = 0; i < pool->numthreads; i++)
+        {
+            SCAN_T total = pool->totals[i];
+            pool->totals[i] = offset;
+            offset = SCAN_COMBINE(offset, total);
+        }
+    }
+    pthread_barrier_wait(&pool->phase_done);
+
+    // phase 3: combine the slice with everything before it; without a carry,
+    // the first slice has nothing before it
+    SCAN_T offset = pool->totals[id];
+    for (size_t i = start; (id > 0 || carry != NULL) && i < end; i++)
+    {
+        out[i] = SCAN_COMBINE(offset, out[i]);
+    }
+}
+
+// Return a pool of numthreads workers for blk_phases, or NULL if memory runs
+// out
+static void *SCAN_NAME(blk_pool)(int numthreads)
+{
+    struct SCAN_NAME(BLKPool) *pool = malloc(sizeof(*pool));
+    if (numthreads < 1)
+    {
+        numthreads = 1;
+    }
+    if (pool != NULL)
+    {
+        pool->totals = malloc(numthreads * sizeof(SCAN_T));
+        pool->numthreads = numthreads;
+        if (pool->totals == NULL)
+        {
+            free(pool);
+            return NULL;
+        }
+        pthread_barrier_init(&pool->phase_done, NULL, numthreads);
+    }
+    return pool;
+}
+
+static void SCAN_NAME(blk_pool_free)(void *arg)
+{
+    struct SCAN_NAME(BLKPool) *pool = arg;
+    if (pool != NULL)
+    {
+        pthread_barrier_destroy(&pool->phase_done);
+        free(pool->totals);
+        free(pool);
+    }
+}
+
+// Scan one block of a stream in place, as worker id of the pool, continuing
+// from the last result of the block before it
+static void SCAN_NAME(blk_block)(void *pool, int id, void *data, int size, const void *carry)
+{
+    SCAN_NAME(blk_phases)(pool, id, data, data, size, carry);
+}
+
+// State shared by the workers of BLK
+struct SCAN_NAME(BLKShared)
+{
+    struct SCAN_NAME(BLKPool) *pool;
+    const SCAN_T *ints;
+    SCAN_T *result;
+    int size;
+};
+
+static void *SCAN_NAME(blk_worker)(void *arg)
+{
+    struct Worker *worker = arg;
+    struct SCAN_NAME(BLKShared) *shared = worker->shared;
+    SCAN_NAME(blk_phases)(shared->pool, worker->id, shared->ints, shared->result, shared->size, NULL);
+    return NULL;
+}
+
+// Return the result of a work-efficient blocked scan
+static void *SCAN_NAME(BLK)(const void *in, int size, int numthreads)
+{
+    struct SCAN_NAME(BLKShared) shared = {SCAN_NAME(blk_pool)(numthreads), in, malloc(size * sizeof(SCAN_T)), size};
+    first_touch(shared.result, sizeof(SCAN_T), size, numthreads);
+    if (shared.pool == NULL || (shared.result == NULL && size > 0) || run_workers(SCAN_NAME(blk_worker), &shared, shared.pool->numthreads) != 0)
+    {
+        free(shared.result);
+        shared.result = NULL;
+    }
+    SCAN_NAME(blk_pool_free)(shared.pool);
+    return shared.result;
+}
+
+// State shared by the workers of SEG
+struct SCAN_NAME(SEGShared)
+{
+    const SCAN_T *ints;
+    const unsigned char *heads;
+    SCAN_T *result;
+    SCAN_T *totals;      // per worker, the scan of its last segment, then the carry into its slice
+    size_t *first_head;  // per worker, the first head in its slice, or the end of the slice
+    int size;
+    int numthreads;
+    pthread_barrier_t phase_done;
+};
+
+static void *SCAN_NAME(seg_worker)(void *arg)
+{
+    struct Worker *worker = arg;
+    struct SCAN_NAME(SEGShared) *shared = worker->shared;
+    const SCAN_T *ints = shared->ints;
+    const unsigned char *heads = shared->heads;
+    SCAN_T *result = shared->result;
+    size_t start;
+    size_t end;
+
+    slice_bounds(shared->size, shared->numthreads, worker->id, &start, &end);
+
+    // phase 1: scan the slice on its own, restarting at every head
+    SCAN_T carry = SCAN_IDENTITY;
+    size_t first_head = end;
+    for (size_t i = start; i < end; i++)
+    {
+        if (heads[i])
+        {
+            first_head = first_head == end ? i : first_head;
+            carry = ints[i];
+        }
+        else
+        {
+            carry = SCAN_COMBINE(carry, ints[i]);
+        }
+        result[i] = carry;
+    }
+    shared->totals[worker->id] = carry;
+    shared->first_head[worker->id] = first_head;
+
+    // phase 2: one worker finds what flows into each slice, which is only
+    // the slices back to the last one holding a head
+    if (pthread_barrier_wait(&shared->phase_done) == PTHREAD_BARRIER_SERIAL_THREAD)
+    {
+        SCAN_T offset = SCAN_IDENTITY;
+        for (int i = 0; i < shared->numthreads; i++)
+        {
+            size_t slice_start;
+            size_t slice_end;
+            slice_bounds(shared->size, shared->numthreads, i, &slice_start, &slice_end);
+            SCAN_T total = shared->totals[i];
+            shared->totals[i] = offset;
+            offset = shared->first_head[i] < slice_end ? total : SCAN_COMBINE(offset, total);
+        }
+    }
+    pthread_barrier_wait(&shared->phase_done);
+
+    // phase 3: carry into the part of the slice before its first head
+    SCAN_T offset = shared->totals[worker->id];
+    for (size_t i = start; worker->id > 0 && i < first_head; i++)
+    {
+        result[i] = SCAN_COMBINE(offset, result[i]);
+    }
+    return NULL;
+}
+
+// Return the result of a segmented scan, blocked like BLK: each thread scans
+// its slice, restarting at heads, then the part of the slice before its
+// first head is combined with the carry from the slices before it.
+static void *SCAN_NAME(SEG)(const void *in, const unsigned char *heads, int size, int numthreads)
+{
+    if (numthreads < 1)
+    {
+        numthreads = 1;
+    }
+
+    struct SCAN_NAME(SEGShared) shared;
+    shared.ints = in;
+    shared.heads = heads;
+    shared.result = malloc(size * sizeof(SCAN_T));
+    first_touch(shared.result, sizeof(SCAN_T), size, numthreads);
+    shared.totals = malloc(numthreads * sizeof(SCAN_T));
+    shared.first_head = malloc(numthreads * sizeof(size_t));
+    shared.size = size;
+    shared.numthreads = numthreads;
+    pthread_barrier_init(&shared.phase_done, NULL, numthreads);
+
+    if ((shared.result == NULL && size > 0) || shared.totals == NULL || shared.first_head == NULL || run_workers(SCAN_NAME(seg_worker), &shared, numthreads) != 0)
+    {
+        free(shared.result);
+        shared.result = NULL;
+    }
+
+    pthread_barrier_destroy(&shared.phase_done);
+    free(shared.totals);
+    free(shared.first_head);
+    return shared.result;
+}
+
+// A chunk of LB as its successors see it. aggregate and prefix are written
+// before status is raised to say they are, and read after status says so.
+struct SCAN_NAME(LBChunk)
+{
+    atomic_int status;
+    SCAN_T aggregate;
+    SCAN_T prefix;
+};
+
+// State shared by the workers of LB
+struct SCAN_NAME(LBShared)
+{
+    const SCAN_T *ints;
+    SCAN_T *result;
+    struct SCAN_NAME(LBChunk) *chunks;
+    size_t num_chunks;
+    int size;
+    int numthreads;
+};
+
+// Combine the chunks before chunk c, newest first, until one with its
+// prefix published: the aggregates of the chunks in between stand in for
+// the prefixes they have not published yet. Return everything before c.
+static SCAN_T SCAN_NAME(look_back)(struct SCAN_NAME(LBChunk) *chunks, size_t c)
+{
+    SCAN_T exclusive = SCAN_IDENTITY;
+    for (size_t j = c; j-- > 0;)
+    {
+        int status;
+        while ((status = atomic_load_explicit(&chunks[j].status, memory_order_acquire)) == LB_EMPTY)
+        {
+            sched_yield();
+        }
+        if (status == LB_PREFIX)
+        {
+            return SCAN_COMBINE(chunks[j].prefix, exclusive);
+        }
+        exclusive = SCAN_COMBINE(chunks[j].aggregate, exclusive);
+    }
+    return exclusive;
+}
+
+static void *SCAN_NAME(lb_worker)(void *arg)
+{
+    struct Worker *worker = arg;
+    struct SCAN_NAME(LBShared) *shared = worker->shared;
+
+    // chunks are dealt round-robin and taken in order, so the lowest chunk
+    // not yet published always has a worker that is not waiting
+    for (size_t c = worker->id; c < shared->num_chunks; c += shared->numthreads)
+    {
+        struct SCAN_NAME(LBChunk) *chunk = &shared->chunks[c];
+        size_t start = c * LB_CHUNK;
+        size_t end = start + LB_CHUNK < (size_t)shared->size ? start + LB_CHUNK : (size_t)shared->size;
+
+        // publish the chunk's total at once, so successors need not wait
+        // for its prefix
+        SCAN_T aggregate = shared->ints[start];
+        for (size_t i = start + 1; i < end; i++)
+        {
+            aggregate = SCAN_COMBINE(aggregate, shared->ints[i]);
+        }
+        SCAN_T exclusive = SCAN_IDENTITY;
+        if (c > 0)
+        {
+            chunk->aggregate = aggregate;
+            atomic_store_explicit(&chunk->status, LB_AGGREGATE, memory_order_release);
+            exclusive = SCAN_NAME(look_back)(shared->chunks, c);
+            aggregate = SCAN_COMBINE(exclusive, aggregate);
+        }
+        chunk->prefix = aggregate;
+        atomic_store_explicit(&chunk->status, LB_PREFIX, memory_order_release);
+
+        // the chunk is still in cache from the reduction, so memory sees
+        // one read and one write per element
+#ifdef SCAN_KERNEL
+        SCAN_KERNEL(shared->ints + start, shared->result + start, end - start, exclusive);
+#else
+        SCAN_NAME(scan_block)(shared->ints + start, shared->result + start, end - start, exclusive);
+#endif
+    }
+    return NULL;
+}
+
+// Return the result of a single-pass scan by decoupled look-back: each
+// chunk publishes its total, then its inclusive prefix once it has found
+// what comes before it by looking back over its predecessors' flags.
+// Pages of the result are first touched by the worker that writes them.
+static void *SCAN_NAME(LB)(const void *in, int size, int numthreads)
+{
+    if (numthreads < 1)
+    {
+        numthreads = 1;
+    }
+
+    struct SCAN_NAME(LBShared) shared;
+    shared.ints = in;
+    shared.result = malloc(size * sizeof(SCAN_T));
+    shared.num_chunks = ((size_t)size + LB_CHUNK - 1) / LB_CHUNK;
+    shared.chunks = malloc(shared.num_chunks * sizeof(struct SCAN_NAME(LBChunk)));
+    shared.size = size;
+    shared.numthreads = numthreads;
+    for (size_t c = 0; shared.chunks != NULL && c < shared.num_chunks; c++)
+    {
+        atomic_init(&shared.chunks[c].status, LB_EMPTY);
+    }
+
+    if (((shared.result == NULL || shared.chunks == NULL) && size > 0) || run_workers(SCAN_NAME(lb_worker), &shared, numthreads) != 0)
+    {
+        free(shared.result);
+        shared.result = NULL;
+    }
+
+    free(shared.chunks);
+    return shared.result;
+}
+
+// State shared by the workers of the in-place modes and REDUCE
+struct SCAN_NAME(RTSShared)
+{
+    SCAN_T *data;
+    SCAN_T *totals; // per worker, the reduction of its slice, then of the slices before it
+    SCAN_T total;   // of every slice, once the totals are offsets
+    int exclusive;  // whether a slice is scanned exclusively, or not at all when -1
+    int size;
+    int numthreads;
+    pthread_barrier_t phase_done;
+};
+
+static void *SCAN_NAME(rts_worker)(void *arg)
+{
+    struct Worker *worker = arg;
+    struct SCAN_NAME(RTSShared) *shared = worker->shared;
+    SCAN_T *data = shared->data;
+    size_t start;
+    size_t end;
+
+    slice_bounds(shared->size, shared->numthreads, worker->id, &start, &end);
+
+    // phase 1: reduce the slice, reading it without writing anything
+    SCAN_T total = SCAN_IDENTITY;
+    for (size_t i = start; i < end; i++)
+    {
+        total = SCAN_COMBINE(total, data[i]);
+    }
+    shared->totals[worker->id] = total;
+    if (shared->exclusive == -1)
+    {
+        return NULL;
+    }
+
+    // phase 2: one worker turns the slice totals into exclusive offsets
+    if (pthread_barrier_wait(&shared->phase_done) == PTHREAD_BARRIER_SERIAL_THREAD)
+    {
+        SCAN_T offset = SCAN_IDENTITY;
+        for (int i = 0; i < shared->numthreads; i++)
+        {
+            SCAN_T slice_total = shared->totals[i];
+            shared->totals[i] = offset;
+            offset = SCAN_COMBINE(offset, slice_total);
+        }
+        shared->total = offset;
+    }
+    pthread_barrier_wait(&shared->phase_done);
+
+    // phase 3: scan the slice over itself, starting from its offset
+    SCAN_T carry = shared->totals[worker->id];
+    if (!shared->exclusive)
+    {
+        SCAN_NAME(scan_block)(data + start, data + start, end - start, carry);
+        return NULL;
+    }
+    for (size_t i = start; i < end; i++)
+    {
+        SCAN_T value = data[i];
+        data[i] = carry;
+        carry = SCAN_COMBINE(carry, value);
+    }
+    return NULL;
+}
+
+// Reduce-then-scan over data without a second vector: each thread reduces
+// its slice, the slice totals are scanned, and each thread scans its slice
+// in place from its offset, exclusively if exclusive is TRUE. With
+// exclusive -1 only the reduction is done. Store the total of data at
+// total. Return 0, or -1 if memory or threads run out.
+static int SCAN_NAME(rts)(SCAN_T *data, int size, int numthreads, int exclusive, SCAN_T *total)
+{
+    if (numthreads < 1)
+    {
+        numthreads = 1;
+    }
+
+    struct SCAN_NAME(RTSShared) shared;
+    shared.data = data;
+    shared.totals = malloc(numthreads * sizeof(SCAN_T));
+    shared.exclusive = exclusive;
+    shared.size = size;
+    shared.numthreads = numthreads;
+    pthread_barrier_init(&shared.phase_done, NULL, numthreads);
+
+    int status = shared.totals != NULL ? run_workers(SCAN_NAME(rts_worker), &shared, numthreads) : -1;
+    if (status == 0 && exclusive == -1)
+    {
+        *total = SCAN_IDENTITY;
+        for (int i = 0; i < numthreads; i++)
+        {
+            *total = SCAN_COMBINE(*total, shared.totals[i]);
+        }
+    }
+    else if (status == 0)
+    {
+        *total = shared.total;
+    }
+    pthread_barrier_destroy(&shared.phase_done);
+    free(shared.totals);
+    return status;
+}
+
+// Overwrite data with its inclusive scan
+static int SCAN_NAME(INPLACE)(void *data, int size, int numthreads)
+{
+    SCAN_T total;
+    return SCAN_NAME(rts)(data, size, numthreads, FALSE, &total);
+}
+
+// Overwrite data with its exclusive scan, which starts from the identity
+static int SCAN_NAME(EXCL)(void *data, int size, int numthreads)
+{
+    SCAN_T total;
+    return SCAN_NAME(rts)(data, size, numthreads, TRUE, &total);
+}
+
+// Store the combination of every element of in at total
+static int SCAN_NAME(REDUCE)(const void *in, int size, int numthreads, void *total)
+{
+    return SCAN_NAME(rts)((SCAN_T *)in, size, numthreads, -1, total);
+}
+
+static const struct ScanModes SCAN_NAME(modes) = {
+    SCAN_NAME(SEQ),
+    SCAN_NAME(SIMD),
+    SCAN_NAME(HSS),
+    SCAN_NAME(HSP),
+    SCAN_NAME(BLK),
+    SCAN_NAME(SEG),
+    SCAN_NAME(blk_pool),
+    SCAN_NAME(blk_block),
+    SCAN_NAME(blk_pool_free),
+    SCAN_NAME(LB),
+    SCAN_NAME(INPLACE),
+    SCAN_NAME(EXCL),
+    SCAN_NAME(REDUCE),
+};
+
+#undef SCAN_OP
+#undef SCAN_COMBINE
+#undef SCAN_IDENTITY
+#undef SCAN_KERNEL
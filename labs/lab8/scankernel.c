@@ -0,0 +1,70 @@
+#include "scankernel.h"
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+int scan_kernel_scalar(const int *in, int *out, int size, int carry)
+{
+    // sum as unsigned, so overflow wraps as the vector kernels do
+    unsigned int sum = carry;
+    for (int i = 0; i < size; i++)
+    {
+        sum += (unsigned int)in[i];
+        out[i] = (int)sum;
+    }
+    return (int)sum;
+}
+
+#if defined(__x86_64__)
+
+// Each vector is scanned in register by shifting and adding, log2(lanes)
+// steps, then the running total of the vectors before it is added to every
+// lane and the last lane becomes the new total.
+int scan_kernel_sse2(const int *in, int *out, int size, int carry)
+{
+    __m128i total = _mm_set1_epi32(carry);
+    int i = 0;
+    for (; i + 4 <= size; i += 4)
+    {
+        __m128i x = _mm_loadu_si128((const __m128i *)&in[i]);
+        x = _mm_add_epi32(x, _mm_slli_si128(x, 4));
+        x = _mm_add_epi32(x, _mm_slli_si128(x, 8));
+        x = _mm_add_epi32(x, total);
+        _mm_storeu_si128((__m128i *)&out[i], x);
+        total = _mm_shuffle_epi32(x, _MM_SHUFFLE(3, 3, 3, 3));
+    }
+    return scan_kernel_scalar(&in[i], &out[i], size - i, _mm_cvtsi128_si32(total));
+}
+
+__attribute__((target("avx2"))) int scan_kernel_avx2(const int *in, int *out, int size, int carry)
+{
+    // the shifts stay within 128-bit lanes, so the low lane's total is
+    // carried into the high lane by a separate step
+    const __m256i low_last = _mm256_setr_epi32(0, 0, 0, 0, 3, 3, 3, 3);
+    const __m256i last = _mm256_set1_epi32(7);
+    __m256i total = _mm256_set1_epi32(carry);
+    int i = 0;
+    for (; i + 8 <= size; i += 8)
+    {
+        __m256i x = _mm256_loadu_si256((const __m256i *)&in[i]);
+        x = _mm256_add_epi32(x, _mm256_slli_si256(x, 4));
+        x = _mm256_add_epi32(x, _mm256_slli_si256(x, 8));
+        __m256i low = _mm256_permutevar8x32_epi32(x, low_last);
+        x = _mm256_add_epi32(x, _mm256_blend_epi32(_mm256_setzero_si256(), low, 0xf0));
+        x = _mm256_add_epi32(x, total);
+        _mm256_storeu_si256((__m256i *)&out[i], x);
+        total = _mm256_permutevar8x32_epi32(x, last);
+    }
+    return scan_kernel_scalar(&in[i], &out[i], size - i, _mm256_cvtsi256_si32(total));
+}
+
+#endif
+
+ScanKernel scan_kernel_select(void)
+{
+#if defined(__x86_64__)
+    return __builtin_cpu_supports("avx2") ? scan_kernel_avx2 : scan_kernel_sse2;
+#else
+    return scan_kernel_scalar;
+#endif
+}
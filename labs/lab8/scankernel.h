@@ -0,0 +1,17 @@
+#ifndef __scankernel_h__
+#define __scankernel_h__
+
+// Inclusive prefix sums of in[0 .. size) into out, starting from carry.
+// Return the last sum, carry for a following block. in and out may alias.
+typedef int (*ScanKernel)(const int *in, int *out, int size, int carry);
+
+int scan_kernel_scalar(const int *in, int *out, int size, int carry);
+#if defined(__x86_64__)
+int scan_kernel_sse2(const int *in, int *out, int size, int carry);
+int scan_kernel_avx2(const int *in, int *out, int size, int carry);
+#endif
+
+// The widest kernel the CPU supports, the scalar one off x86-64
+ScanKernel scan_kernel_select(void);
+
+#endif
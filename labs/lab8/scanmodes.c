@@ -0,0 +1,51 @@
+#include <stdlib.h>
+#include <stdatomic.h>
+#include <sched.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <pthread.h>
+#include "barrier.h"
+#include "scan.h"
+#include "scankernel.h"
+#include "workers.h"
+
+#define TRUE 1
+#define FALSE 0
+
+// The scan modes of every element type and operator, see scanimpl.h
+
+#define SCAN_TYPE i32
+#define SCAN_T int32_t
+#define SCAN_U uint32_t
+#define SCAN_LOWEST INT32_MIN
+#define SCAN_HIGHEST INT32_MAX
+#define SCAN_SUM_KERNEL scan_kernel_select()
+#include "scanops.h"
+
+#define SCAN_TYPE i64
+#define SCAN_T int64_t
+#define SCAN_U uint64_t
+#define SCAN_LOWEST INT64_MIN
+#define SCAN_HIGHEST INT64_MAX
+#include "scanops.h"
+
+#define SCAN_TYPE f32
+#define SCAN_T float
+#define SCAN_LOWEST (-INFINITY)
+#define SCAN_HIGHEST INFINITY
+#include "scanops.h"
+
+#define SCAN_TYPE f64
+#define SCAN_T double
+#define SCAN_LOWEST (-INFINITY)
+#define SCAN_HIGHEST INFINITY
+#include "scanops.h"
+
+// Indexed by enum ScanType, then enum ScanOp
+static const struct ScanModes *const *const scan_modes[NUM_SCAN_TYPES] = {ops_i32, ops_i64, ops_f32, ops_f64};
+
+const struct ScanModes *scan_modes_for(enum ScanType type, enum ScanOp op)
+{
+    return scan_modes[type][op];
+}
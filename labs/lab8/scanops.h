@@ -0,0 +1,64 @@
+// Instantiate the scan modes of scanimpl.h for every operator on one element
+// type, and collect them in ops_<type>, indexed by enum ScanOp. Expects:
+//
+//   SCAN_TYPE                    the type's name suffix, e.g. i32
+//   SCAN_T                       the element type
+//   SCAN_U                       its unsigned twin, for integer types only
+//   SCAN_LOWEST, SCAN_HIGHEST    the identities of max and min
+//   SCAN_SUM_KERNEL              optional, a vector kernel for sums
+//
+// All of these are undefined at the end.
+
+#ifndef SCAN_ROW
+#define SCAN_ROW_PASTE(name, type) name##_##type
+#define SCAN_ROW_EXPAND(name, type) SCAN_ROW_PASTE(name, type)
+#define SCAN_ROW(name) SCAN_ROW_EXPAND(name, SCAN_TYPE)
+#endif
+
+#define SCAN_OP sum
+#define SCAN_IDENTITY 0
+#ifdef SCAN_U
+// sum as unsigned, so integer overflow wraps instead of being undefined
+#define SCAN_COMBINE(a, b) ((SCAN_T)((SCAN_U)(a) + (SCAN_U)(b)))
+#else
+#define SCAN_COMBINE(a, b) ((a) + (b))
+#endif
+#ifdef SCAN_SUM_KERNEL
+#define SCAN_KERNEL SCAN_SUM_KERNEL
+#endif
+#include "scanimpl.h"
+
+#define SCAN_OP max
+#define SCAN_IDENTITY SCAN_LOWEST
+#define SCAN_COMBINE(a, b) ((a) > (b) ? (a) : (b))
+#include "scanimpl.h"
+
+#define SCAN_OP min
+#define SCAN_IDENTITY SCAN_HIGHEST
+#define SCAN_COMBINE(a, b) ((a) < (b) ? (a) : (b))
+#include "scanimpl.h"
+
+#ifdef SCAN_U
+#define SCAN_OP xor
+#define SCAN_IDENTITY 0
+#define SCAN_COMBINE(a, b) ((a) ^ (b))
+#include "scanimpl.h"
+#endif
+
+static const struct ScanModes *const SCAN_ROW(ops)[NUM_SCAN_OPS] = {
+    &SCAN_EXPAND(modes, SCAN_TYPE, sum),
+    &SCAN_EXPAND(modes, SCAN_TYPE, max),
+    &SCAN_EXPAND(modes, SCAN_TYPE, min),
+#ifdef SCAN_U
+    &SCAN_EXPAND(modes, SCAN_TYPE, xor),
+#else
+    NULL,
+#endif
+};
+
+#undef SCAN_TYPE
+#undef SCAN_T
+#undef SCAN_U
+#undef SCAN_LOWEST
+#undef SCAN_HIGHEST
+#undef SCAN_SUM_KERNEL
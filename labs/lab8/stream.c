@@ -0,0 +1,243 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+#include "barrier.h"
+#include "stream.h"
+#include "workers.h"
+
+#define TRUE 1
+#define FALSE 0
+
+// Blocks in flight: one being read, one being scanned and one being written
+#define STREAM_SLOTS 3
+
+enum SlotState
+{
+    SLOT_EMPTY,   // free for the reader
+    SLOT_READ,    // waiting to be scanned
+    SLOT_SCANNED, // waiting to be written
+};
+
+// A block buffer, passed from the reader to the scanner to the writer and
+// back. A count of 0 ends the stream, -1 ends it on a read error.
+struct Slot
+{
+    void *data;
+    int count;
+    enum SlotState state;
+};
+
+struct Stream
+{
+    struct Slot slots[STREAM_SLOTS];
+    pthread_mutex_t lock;
+    pthread_cond_t changed; // some slot changed state, or the stream stopped
+    int stopped;            // the stages are to give up, as the scan never started
+    struct VectorReader reader;
+    FILE *output;
+    const struct StreamConfig *config;
+    int failed;             // set by the writer
+
+    // the scanning workers, which live for the whole stream
+    void *pool;
+    pthread_barrier_t block_done; // a block is handed to the workers, or scanned
+    union
+    {
+        int64_t i;
+        double d;
+    } carry;                // room for an element of any type
+    int carried;            // whether carry holds the last result so far
+};
+
+// Wait until the slot is in the given state. Return FALSE if the stream
+// stopped instead.
+static int wait_for(struct Stream *stream, struct Slot *slot, enum SlotState state)
+{
+    pthread_mutex_lock(&stream->lock);
+    while (slot->state != state && !stream->stopped)
+    {
+        pthread_cond_wait(&stream->changed, &stream->lock);
+    }
+    int reached = slot->state == state;
+    pthread_mutex_unlock(&stream->lock);
+    return reached;
+}
+
+static void stop(struct Stream *stream)
+{
+    pthread_mutex_lock(&stream->lock);
+    stream->stopped = TRUE;
+    pthread_cond_broadcast(&stream->changed);
+    pthread_mutex_unlock(&stream->lock);
+}
+
+static void hand_over(struct Stream *stream, struct Slot *slot, enum SlotState state)
+{
+    pthread_mutex_lock(&stream->lock);
+    slot->state = state;
+    pthread_cond_broadcast(&stream->changed);
+    pthread_mutex_unlock(&stream->lock);
+}
+
+static void *read_blocks(void *arg)
+{
+    struct Stream *stream = arg;
+    int count = 1;
+    for (int k = 0; count > 0; k++)
+    {
+        struct Slot *slot = &stream->slots[k % STREAM_SLOTS];
+        if (!wait_for(stream, slot, SLOT_EMPTY))
+        {
+            break;
+        }
+        count = vector_reader_read(&stream->reader, slot->data);
+        slot->count = count;
+        hand_over(stream, slot, SLOT_READ);
+    }
+    return NULL;
+}
+
+static void *write_blocks(void *arg)
+{
+    struct Stream *stream = arg;
+    const struct StreamConfig *config = stream->config;
+    int count = 1;
+    for (int k = 0; count > 0; k++)
+    {
+        struct Slot *slot = &stream->slots[k % STREAM_SLOTS];
+        if (!wait_for(stream, slot, SLOT_SCANNED))
+        {
+            break;
+        }
+        count = slot->count;
+
+        // after a failure, keep draining so the other stages finish
+        stream->failed |= count < 0;
+        if (count > 0 && !stream->failed)
+        {
+            if (config->output_format == FORMAT_TEXT)
+            {
+                stream->failed = write_vector(stream->output, slot->data, count, config->type, config->numthreads) != 0;
+            }
+            else
+            {
+                stream->failed = write_binary_vector(stream->output, slot->data, count, config->type, config->output_format) != 0;
+            }
+        }
+        hand_over(stream, slot, SLOT_EMPTY);
+    }
+    return NULL;
+}
+
+// One of the workers scanning the stream. Worker 0 waits for each block and
+// hands it to the others, and once they have all scanned it, passes it on.
+static void *scan_blocks(void *arg)
+{
+    struct Worker *worker = arg;
+    struct Stream *stream = worker->shared;
+    const struct ScanModes *modes = stream->config->modes;
+    size_t element = scan_type_size(stream->config->type);
+    int count = 1;
+    for (int k = 0; count > 0; k++)
+    {
+        struct Slot *slot = &stream->slots[k % STREAM_SLOTS];
+        if (worker->id == 0)
+        {
+            wait_for(stream, slot, SLOT_READ);
+        }
+        pthread_barrier_wait(&stream->block_done);
+        count = slot->count;
+        if (count > 0)
+        {
+            modes->blk_block(stream->pool, worker->id, slot->data, count, stream->carried ? &stream->carry : NULL);
+        }
+        pthread_barrier_wait(&stream->block_done);
+
+        // the last result of each block is the carry into the next
+        if (worker->id == 0)
+        {
+            if (count > 0)
+            {
+                memcpy(&stream->carry, (char *)slot->data + (count - 1) * element, element);
+                stream->carried = TRUE;
+            }
+            hand_over(stream, slot, SLOT_SCANNED);
+        }
+    }
+    return NULL;
+}
+
+int stream_scan(FILE *input, FILE *output, const struct StreamConfig *config)
+{
+    struct Stream stream;
+    size_t element = scan_type_size(config->type);
+    int numthreads = config->numthreads < 1 ? 1 : config->numthreads;
+    int status = 0;
+
+    stream.output = output;
+    stream.config = config;
+    stream.failed = FALSE;
+    stream.stopped = FALSE;
+    stream.carried = FALSE;
+    if (vector_reader_init(&stream.reader, input, config->input_format, config->type, config->block_size) != 0)
+    {
+        return -1;
+    }
+    int capacity = stream.reader.capacity;
+    for (int i = 0; i < STREAM_SLOTS; i++)
+    {
+        stream.slots[i].data = malloc(capacity * element);
+        first_touch(stream.slots[i].data, element, capacity, numthreads);
+        stream.slots[i].state = SLOT_EMPTY;
+        status = stream.slots[i].data == NULL ? -1 : status;
+    }
+    stream.pool = config->modes->blk_pool(numthreads);
+    status = stream.pool == NULL ? -1 : status;
+
+    if (status == 0)
+    {
+        pthread_t reader;
+        pthread_t writer;
+        pthread_mutex_init(&stream.lock, NULL);
+        pthread_cond_init(&stream.changed, NULL);
+        pthread_barrier_init(&stream.block_done, NULL, numthreads);
+        int started = 0;
+        if (pthread_create(&reader, NULL, read_blocks, &stream) == 0)
+        {
+            started++;
+            if (pthread_create(&writer, NULL, write_blocks, &stream) == 0)
+            {
+                started++;
+            }
+        }
+
+        // scan on this thread and the pool's; if any of the threads cannot
+        // start, the stages that did are stopped
+        if (started < 2 || run_workers(scan_blocks, &stream, numthreads) != 0)
+        {
+            stop(&stream);
+            status = -1;
+        }
+        if (started > 0)
+        {
+            pthread_join(reader, NULL);
+        }
+        if (started > 1)
+        {
+            pthread_join(writer, NULL);
+        }
+        pthread_barrier_destroy(&stream.block_done);
+        pthread_mutex_destroy(&stream.lock);
+        pthread_cond_destroy(&stream.changed);
+        status = stream.failed ? -1 : status;
+    }
+
+    config->modes->blk_pool_free(stream.pool);
+    for (int i = 0; i < STREAM_SLOTS; i++)
+    {
+        free(stream.slots[i].data);
+    }
+    vector_reader_free(&stream.reader);
+    return status;
+}
@@ -0,0 +1,29 @@
+#ifndef __stream_h__
+#define __stream_h__
+
+#include <stdio.h>
+#include "scan.h"
+#include "intio.h"
+
+#define STREAM_DEFAULT_BLOCK (1 << 20)
+
+// How stream_scan reads, scans and writes
+struct StreamConfig
+{
+    enum ScanType type;
+    enum VectorFormat input_format;
+    enum VectorFormat output_format;
+    const struct ScanModes *modes;
+    int block_size; // values per block
+    int numthreads; // workers scanning, and formatting text, each block
+};
+
+// Scan input into output a block at a time, so memory stays bounded by a few
+// blocks however long the input is. One thread reads blocks, the calling
+// thread and a pool of workers that lives for the whole stream scan them as
+// BLK does, carrying the last result into the next block, and one thread
+// writes them, all three stages at once. Return 0 on success, -1 on a read
+// or write error or if memory or threads run out.
+int stream_scan(FILE *input, FILE *output, const struct StreamConfig *config);
+
+#endif
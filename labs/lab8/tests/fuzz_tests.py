@@ -0,0 +1,192 @@
+#!/usr/bin/env python3
+
+import sys
+import os
+import re
+import random
+import struct
+import subprocess
+
+usage = "Usage: [SEED=<seed>] fuzz_tests.py <#cases> [prefixscan binaries...]\n"
+
+# Random cases checked against a reference scan in Python. Any difference,
+# nonzero exit or output on stderr fails the case, so a binary built with
+# -fsanitize=address,undefined or -fsanitize=thread also fails on any report
+# from the sanitizer.
+
+types = ["i32", "i64", "f32", "f64"]
+codes = {"i32": "i", "i64": "q", "f32": "f", "f64": "d"}
+bits = {"i32": 32, "i64": 64}
+scan_modes = ["SEQ", "SIMD", "HSS", "HSP", "BLK", "LB", "INPLACE", "EXCL", "REDUCE"]
+
+def normalize(value, t):
+    if t in bits:
+        return (value + 2 ** (bits[t] - 1)) % 2 ** bits[t] - 2 ** (bits[t] - 1)
+    if t == "f32":
+        return struct.unpack("<f", struct.pack("<f", value))[0]
+    return value
+
+def combine(a, b, op, t):
+    if op == "sum":
+        return normalize(a + b, t)
+    if op == "max":
+        return max(a, b)
+    if op == "min":
+        return min(a, b)
+    return a ^ b
+
+def identity(op, t):
+    if op in ["sum", "xor"]:
+        return 0
+    if t in bits:
+        return -2 ** (bits[t] - 1) if op == "max" else 2 ** (bits[t] - 1) - 1
+    return float("-inf") if op == "max" else float("inf")
+
+def scan(values, op, t, heads=None):
+    result = []
+    for i, v in enumerate(values):
+        fresh = not result or (heads is not None and heads[i])
+        result.append(v if fresh else combine(result[-1], v, op, t))
+    return result
+
+def expected(values, op, t, mode):
+    inclusive = scan(values, op, t)
+    if mode == "EXCL":
+        return ([identity(op, t)] + inclusive[:-1]) if values else []
+    if mode == "REDUCE":
+        return inclusive[-1:] if values else [identity(op, t)]
+    return inclusive
+
+# Values of a type; floating-point ones are exact in few bits, so that every
+# order of combining them gives the same sums
+def random_values(t, n):
+    if t in bits:
+        limit = 2 ** (bits[t] - 1)
+        return [random.randint(-limit, limit - 1) for _ in range(n)]
+    return [random.choice([0.5, 0.25, 1.0, -2.0, 3.0, -0.75]) * random.choice([1, 2, 4]) for _ in range(n)]
+
+def write_values(path, values, fmt):
+    if fmt is None:
+        open(path, "w").write(" \n".join(map(str, values)))
+    else:
+        open(path, "wb").write(struct.pack("<%d%s" % (len(values), codes[fmt]), *values))
+
+def read_values(path, fmt, t):
+    data = open(path, "rb").read()
+    if fmt is None:
+        return [(float if t[0] == "f" else int)(x) for x in data.split()]
+    width = struct.calcsize(codes[fmt])
+    return list(struct.unpack("<%d%s" % (len(data) // width, codes[fmt]), data[:len(data) // width * width]))
+
+def run(binary, args, stdin=None):
+    options = ["-a"] if pinning and random.random() < 0.5 else []
+    return subprocess.run([binary] + options + args, input=stdin, capture_output=True)
+
+# Every type, operator and in-memory mode, from text or binary, to text or binary
+def scan_case(binary):
+    t = random.choice(types)
+    op = random.choice(["sum", "max", "min"] + (["xor"] if t in bits else []))
+    mode = random.choice(scan_modes)
+    values = [normalize(v, t) for v in random_values(t, random.choice([0, 1, 2, 3, 7, 100, 1000, 8192, 8193, 30000]))]
+    informat = random.choice([None, t])
+    outformat = random.choice([None, t])
+    write_values("fuzz.in", values, informat)
+    args = ["-t", t, "-p", op] + (["-i", t] if informat else []) + (["-o", t] if outformat else [])
+    args += [mode, str(random.choice([1, 2, 3, 8])), "fuzz.in", "fuzz.out"]
+    return args, run(binary, args), read_values("fuzz.out", outformat, t), expected(values, op, t, mode)
+
+# Streams in blocks of any size, from files and pipes, with text cut short
+# by a token that is not a value, or binary narrowed from i64 or ending in a
+# partial element
+def stream_case(binary):
+    t = random.choice(["i32", "i64", "f64"])
+    op = random.choice(["sum", "max", "min"] + (["xor"] if t in bits else []))
+    values = [normalize(v, t) for v in random_values(t, random.choice([0, 1, 2, 5, 17, 100, 1000, 5000]))]
+    informat = random.choice([None, t] + (["i64"] if t in bits else []))
+    if informat is None:
+        tokens = list(map(str, values))
+        if tokens and random.random() < 0.2:
+            cut = random.randrange(len(tokens))
+            tokens[cut] = "zz"
+            values = values[:cut]
+        separators = [random.choice([" ", "\n", "   ", "\t\n"]) for _ in tokens]
+        open("fuzz.in", "w").write(random.choice(["", " ", "\n"]) + "".join(a + b for a, b in zip(tokens, separators)))
+    else:
+        write_values("fuzz.in", values, informat)
+        open("fuzz.in", "ab").write(b"\x01" * random.randint(0, struct.calcsize(codes[informat]) - 1))
+    outformat = random.choice([None, t])
+    args = ["-t", t, "-p", op, "-b", str(random.choice([1, 2, 3, 7, 64, 100000]))]
+    args += (["-i", informat] if informat else []) + (["-o", t] if outformat else [])
+    if random.random() < 0.3:
+        args += ["STREAM", str(random.choice([1, 2, 3, 5])), "/dev/stdin", "fuzz.out"]
+        result = run(binary, args, open("fuzz.in", "rb").read())
+    else:
+        args += ["STREAM", str(random.choice([1, 2, 3, 5])), "fuzz.in", "fuzz.out"]
+        result = run(binary, args)
+    return args, result, read_values("fuzz.out", outformat, t), scan(values, op, t)
+
+# Segmented scans, with heads given as flags or as indices
+def seg_case(binary):
+    t = random.choice(["i32", "i64"])
+    op = random.choice(["sum", "max", "min", "xor"])
+    n = random.choice([1, 2, 5, 17, 100, 1000])
+    values = [normalize(v, t) for v in random_values("i32", n)]
+    density = random.choice([0, 0.01, 0.2, 0.9])
+    heads = [random.random() < density for _ in range(n)]
+    write_values("fuzz.in", values, None)
+    if random.random() < 0.5:
+        indices = [i for i in range(n) if heads[i]]
+        random.shuffle(indices)
+        open("fuzz.heads", "w").write("\n".join(map(str, indices)))
+        option = "-g"
+    else:
+        open("fuzz.heads", "w").write(" ".join(str(random.choice([1, -3, 7]) if h else 0) for h in heads))
+        option = "-f"
+    args = ["-t", t, "-p", op, option, "fuzz.heads", "SEG", str(random.choice([1, 2, 3, 4, 8, 33])), "fuzz.in", "fuzz.out"]
+    return args, run(binary, args), read_values("fuzz.out", None, t), scan(values, op, t, heads)
+
+# Text that ends at the first token that is not a whole value
+def parse_case(binary):
+    tokens = [str(random.randint(-1000, 1000)) for _ in range(random.randint(0, 60))]
+    if tokens and random.random() < 0.3:
+        tokens[random.randrange(len(tokens))] = random.choice(["x", "abc", "-", "1.5"])
+    text = "".join(t + random.choice([" ", "\n", "  ", "\t", " \n "]) for t in tokens)
+    text = text.rstrip() if random.random() < 0.3 else text
+    open("fuzz.in", "w").write(text)
+    values = []
+    for token in text.split():
+        match = re.match(r"[-+]?\d+", token)
+        if not match:
+            break
+        values.append(int(match.group()))
+        if match.group() != token:
+            break
+    args = ["BLK", str(random.choice([1, 2, 3, 5, 16])), "fuzz.in", "fuzz.out"]
+    return args, run(binary, args), read_values("fuzz.out", None, "i32"), scan(values, "sum", "i32")
+
+if len(sys.argv) < 2:
+    sys.stderr.write(usage)
+    exit(1)
+
+cases = int(sys.argv[1])
+seed = int(os.environ.get("SEED") or random.randrange(2 ** 32))
+binaries = sys.argv[2:] or ["../prefixscan.out"]
+pinning = sys.platform.startswith("linux")
+os.environ["ASAN_OPTIONS"] = "detect_leaks=0"
+random.seed(seed)
+print("Fuzzing %d cases with seed %d" % (cases, seed))
+
+failed = 0
+for _ in range(cases):
+    binary = random.choice(binaries)
+    args, result, got, want = random.choice([scan_case, stream_case, seg_case, parse_case])(binary)
+    if got != want or result.returncode != 0 or result.stderr:
+        failed += 1
+        print("\033[91mFAILED\033[0m " + binary + " " + " ".join(args))
+        sys.stdout.write(result.stderr.decode(errors="replace")[:1000])
+os.system("rm -f fuzz.in fuzz.out fuzz.heads")
+
+if failed > 0:
+    print("%d of %d cases failed" % (failed, cases))
+    sys.exit(1)
+print("\033[92mPASSED\033[0m %d cases" % cases)
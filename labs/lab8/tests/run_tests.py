@@ -2,6 +2,7 @@
 
 import sys
 import os
+import struct
 
 tests = [
     "the simplest case: 2 entries in the vector, both are 1",
@@ -15,22 +16,145 @@ tests = [
     "evaluate 32 entries in the vector, each are different and randomized",
     "evaluate 4096 entries in the vector, each are different and randomized",
     "testing with 32K input vector",
-    "testing with 2**22 sized input vector"
+    "testing with 2**22 sized input vector",
+    "i64 sums beyond 32 bits, wrapping past the largest value",
+    "i32 sums wrapping around",
+    "i32 running maximum, from negative values",
+    "i32 running minimum",
+    "i64 running xor",
+    "f32 running maximum, printed so every value reads back exactly",
+    "f64 sums of exact fractions",
+    "f64 running minimum, printed so every value reads back exactly",
+    "f32 sums of exact halves",
+    "binary i32 in and out, read in place, a trailing partial element dropped",
+    "binary i64 narrowed to i32, keeping the low bits",
+    "binary i32 sign-extended to i64, in and out",
+    "binary f32 in and out",
+    "binary f64 in, text out",
+    "i32 written as binary i64, sign-extended",
+    "segmented sum, flags with a head at 0",
+    "segmented sum, nonzero flags without a head at 0",
+    "segmented max, head indices unsorted and repeated, including 0",
+    "segmented sum, a head index out of range is rejected",
+    "segmented sum, too few flags are rejected",
+    "segmented sum, head indices without 0",
+    "in-place sum",
+    "in-place maximum",
+    "exclusive sum, starting from 0",
+    "exclusive maximum, starting from the lowest i32",
+    "exclusive minimum, starting from the highest i32",
+    "exclusive f32 maximum, starting from -inf",
+    "reduction to the sum",
+    "reduction to the maximum",
+    "reduction of an empty vector to the identity of min",
+    "reduction of i64 values to their maximum",
 ]
 
+# Options of the tests past the original ones, which run in the mode given
+# on the command line unless they are in modes
+options = {
+    12: "-t i64",
+    14: "-p max",
+    15: "-p min",
+    16: "-t i64 -p xor",
+    17: "-t f32 -p max",
+    18: "-t f64",
+    19: "-t f64 -p min",
+    20: "-t f32",
+    22: "-t i32",
+    23: "-t i64",
+    24: "-t f32",
+    25: "-t f64 -p min",
+    26: "-t i32",
+    27: "-f test27.flags",
+    28: "-f test28.flags",
+    29: "-p max -g test29.heads",
+    30: "-g test30.heads",
+    31: "-f test31.flags",
+    32: "-g test32.heads",
+    34: "-p max",
+    36: "-p max",
+    37: "-p min",
+    38: "-t f32 -p max",
+    40: "-p max",
+    41: "-p min",
+    42: "-t i64 -p max",
+}
+
+# Tests of the binary formats, as the formats of the input and the output,
+# None for text, and bytes to append to the input. The input is packed from
+# the text fixture and the output unpacked back to text for the comparison.
+binary = {
+    21: ("i32", "i32", b"\x07\x00"),
+    22: ("i64", None, b""),
+    23: ("i32", "i64", b""),
+    24: ("f32", "f32", b""),
+    25: ("f64", None, b""),
+    26: (None, "i64", b""),
+}
+codes = {"i32": "i", "i64": "q", "f32": "f", "f64": "d"}
+
+def to_binary(textf, binf, fmt, trailing):
+    values = [(float if fmt[0] == "f" else int)(x) for x in open(textf).read().split()]
+    open(binf, "wb").write(struct.pack("<%d%s" % (len(values), codes[fmt]), *values) + trailing)
+
+def to_text(binf, fmt):
+    data = open(binf, "rb").read()
+    values = struct.unpack("<%d%s" % (len(data) // struct.calcsize(codes[fmt]), codes[fmt]), data)
+    pattern = {"f32": "%.9g\n", "f64": "%.17g\n"}.get(fmt, "%d\n")
+    open(binf, "w").write("".join(pattern % v for v in values))
+
+# Tests of modes that need more than a vector or give more than its
+# inclusive scan, run in their own mode whatever the mode given
+modes = {
+    27: "SEG",
+    28: "SEG",
+    29: "SEG",
+    30: "SEG",
+    31: "SEG",
+    32: "SEG",
+    33: "INPLACE",
+    34: "INPLACE",
+    35: "EXCL",
+    36: "EXCL",
+    37: "EXCL",
+    38: "EXCL",
+    39: "REDUCE",
+    40: "REDUCE",
+    41: "REDUCE",
+    42: "REDUCE",
+}
+
+# Tests where prefixscan has to fail, writing nothing
+failing = [30, 31]
+
 usage = "Usage: run_tests.py r <mode> <#threads> <test>, or run_test.py p <test>\n"
 
 def run_test(testnum, mode, numthreads):
     sys.stdout.write("Running test " + str(testnum) + ": " + tests[testnum] + "... ")
     inf = "test" + str(testnum) + ".in"
     outf = "test" + str(testnum) + ".out"
-    os.system("../prefixscan.out " + mode + " " + numthreads + " " + inf + " temp.txt > /dev/null 2> /dev/null")
-    if os.system("diff temp.txt " + outf + " > /dev/null") != 0:
+    if not os.path.exists(inf):
+        print("\033[93mSKIPPED\033[0m (no fixture)")
+        return
+    opts = options.get(testnum, "")
+    mode = modes.get(testnum, mode)
+    informat, outformat, trailing = binary.get(testnum, (None, None, b""))
+    if informat is not None:
+        to_binary(inf, "temp.in", informat, trailing)
+        opts += " -i " + informat
+        inf = "temp.in"
+    if outformat is not None:
+        opts += " -o " + outformat
+    status = os.system("../prefixscan.out " + opts + " " + mode + " " + numthreads + " " + inf + " temp.txt > /dev/null 2> /dev/null")
+    if outformat is not None:
+        to_text("temp.txt", outformat)
+    if (status != 0) != (testnum in failing) or os.system("diff temp.txt " + outf + " > /dev/null") != 0:
         print("\033[91mFAILED\033[0m")
         sys.exit(1)
     else:
         print("\033[92mPASSED\033[0m")
-    os.system("rm temp.txt")
+    os.system("rm -f temp.txt temp.in")
 
 if len(sys.argv) < 2:
     sys.stderr.write(usage)
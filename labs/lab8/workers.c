@@ -0,0 +1,266 @@
+#ifdef __linux__
+#define _GNU_SOURCE
+#include <sched.h>
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "workers.h"
+
+#define TRUE 1
+#define FALSE 0
+
+#ifdef __linux__
+
+// CPUs workers are pinned to, worker i to cpu_order[i % num_cpus], or none
+static int *cpu_order = NULL;
+static int num_cpus = 0;
+
+// Socket of a CPU, 0 where the topology cannot be read
+static int cpu_package(int cpu)
+{
+    char path[128];
+    int package = 0;
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/physical_package_id", cpu);
+    FILE *file = fopen(path, "r");
+    if (file != NULL)
+    {
+        if (fscanf(file, "%d", &package) != 1)
+        {
+            package = 0;
+        }
+        fclose(file);
+    }
+    return package;
+}
+
+int workers_pin(int enabled)
+{
+    cpu_set_t allowed;
+    free(cpu_order);
+    cpu_order = NULL;
+    num_cpus = 0;
+    if (!enabled)
+    {
+        return 0;
+    }
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0)
+    {
+        return -1;
+    }
+
+    int count = CPU_COUNT(&allowed);
+    int *cpus = malloc(count * sizeof(int));
+    int *ranks = malloc(count * sizeof(int)); // CPUs before it on its socket
+    int *packages = malloc(count * sizeof(int));
+    cpu_order = malloc(count * sizeof(int));
+    if (cpus == NULL || ranks == NULL || packages == NULL || cpu_order == NULL)
+    {
+        free(cpus);
+        free(ranks);
+        free(packages);
+        free(cpu_order);
+        cpu_order = NULL;
+        return -1;
+    }
+    for (int cpu = 0, i = 0; i < count; cpu++)
+    {
+        if (CPU_ISSET(cpu, &allowed))
+        {
+            cpus[i] = cpu;
+            packages[i] = cpu_package(cpu);
+            ranks[i] = 0;
+            for (int j = 0; j < i; j++)
+            {
+                ranks[i] += packages[j] == packages[i];
+            }
+            i++;
+        }
+    }
+
+    // deal the CPUs out one socket at a time, so any number of workers is
+    // spread over all sockets and their memory
+    for (int rank = 0; num_cpus < count; rank++)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            if (ranks[i] == rank)
+            {
+                cpu_order[num_cpus++] = cpus[i];
+            }
+        }
+    }
+    free(cpus);
+    free(ranks);
+    free(packages);
+    return 0;
+}
+
+static void pin(pthread_t thread, int id)
+{
+    cpu_set_t one;
+    CPU_ZERO(&one);
+    CPU_SET(cpu_order[id % num_cpus], &one);
+    pthread_setaffinity_np(thread, sizeof(one), &one);
+}
+
+#else
+
+int workers_pin(int enabled)
+{
+    return enabled ? -1 : 0;
+}
+
+#endif
+
+// Where the threads of a run wait until all of them have started, so that
+// no worker runs unless every one of them can
+struct Gate
+{
+    pthread_mutex_t lock;
+    pthread_cond_t opened;
+    int state; // 0 while threads are starting, then 1 to run or -1 to give up
+};
+
+// A worker to run on its own thread once the gate opens
+struct Launch
+{
+    struct Worker worker;
+    void *(*fn)(void *);
+    struct Gate *gate;
+};
+
+static void *launch(void *arg)
+{
+    struct Launch *launch = arg;
+    struct Gate *gate = launch->gate;
+
+    pthread_mutex_lock(&gate->lock);
+    while (gate->state == 0)
+    {
+        pthread_cond_wait(&gate->opened, &gate->lock);
+    }
+    int run = gate->state == 1;
+    pthread_mutex_unlock(&gate->lock);
+    return run ? launch->fn(&launch->worker) : NULL;
+}
+
+static void open_gate(struct Gate *gate, int state)
+{
+    pthread_mutex_lock(&gate->lock);
+    gate->state = state;
+    pthread_cond_broadcast(&gate->opened);
+    pthread_mutex_unlock(&gate->lock);
+}
+
+int run_workers(void *(*fn)(void *), void *shared, int numthreads)
+{
+    pthread_t *threads = malloc(numthreads * sizeof(pthread_t));
+    struct Launch *launches = malloc(numthreads * sizeof(struct Launch));
+    struct Gate gate;
+    if (threads == NULL || launches == NULL)
+    {
+        free(threads);
+        free(launches);
+        return -1;
+    }
+    pthread_mutex_init(&gate.lock, NULL);
+    pthread_cond_init(&gate.opened, NULL);
+    gate.state = 0;
+    for (int i = 0; i < numthreads; i++)
+    {
+        launches[i].worker.shared = shared;
+        launches[i].worker.id = i;
+        launches[i].fn = fn;
+        launches[i].gate = &gate;
+    }
+
+    // workers wait for each other at barriers, so the run only goes ahead
+    // once every thread is there
+    int started = 1;
+    while (started < numthreads && pthread_create(&threads[started], NULL, launch, &launches[started]) == 0)
+    {
+#ifdef __linux__
+        if (cpu_order != NULL)
+        {
+            pin(threads[started], started);
+        }
+#endif
+        started++;
+    }
+    int status = started == numthreads ? 0 : -1;
+    open_gate(&gate, status == 0 ? 1 : -1);
+
+    if (status == 0)
+    {
+#ifdef __linux__
+        // the calling thread is pinned only while it works as worker 0
+        cpu_set_t saved;
+        int pinned = cpu_order != NULL && pthread_getaffinity_np(pthread_self(), sizeof(saved), &saved) == 0;
+        if (pinned)
+        {
+            pin(pthread_self(), 0);
+        }
+#endif
+        fn(&launches[0].worker);
+#ifdef __linux__
+        if (pinned)
+        {
+            pthread_setaffinity_np(pthread_self(), sizeof(saved), &saved);
+        }
+#endif
+    }
+
+    for (int i = 1; i < started; i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+    pthread_cond_destroy(&gate.opened);
+    pthread_mutex_destroy(&gate.lock);
+    free(threads);
+    free(launches);
+    return status;
+}
+
+void slice_bounds(size_t size, int numthreads, int id, size_t *start, size_t *end)
+{
+    size_t chunk = (size + numthreads - 1) / numthreads;
+    *start = id * chunk < size ? id * chunk : size;
+    *end = *start + chunk < size ? *start + chunk : size;
+}
+
+// State shared by the workers of first_touch
+struct TouchShared
+{
+    char *buffer;
+    size_t element;
+    size_t size;
+    int numthreads;
+};
+
+static void *touch_worker(void *arg)
+{
+    struct Worker *worker = arg;
+    struct TouchShared *shared = worker->shared;
+    size_t page = sysconf(_SC_PAGESIZE);
+    size_t start;
+    size_t end;
+
+    slice_bounds(shared->size, shared->numthreads, worker->id, &start, &end);
+    for (size_t i = start * shared->element; i < end * shared->element; i += page)
+    {
+        shared->buffer[i] = 0;
+    }
+    return NULL;
+}
+
+void first_touch(void *buffer, size_t element, size_t size, int numthreads)
+{
+    struct TouchShared shared = {buffer, element, size, numthreads};
+    // placement is only a hint, so a run that cannot start is not an error
+    if (buffer != NULL && numthreads > 1)
+    {
+        run_workers(touch_worker, &shared, numthreads);
+    }
+}
@@ -0,0 +1,31 @@
+#ifndef __workers_h__
+#define __workers_h__
+
+#include <stddef.h>
+
+// Worker id of numthreads, running a function on state shared by all of them
+struct Worker
+{
+    void *shared;
+    int id;
+};
+
+// Run fn on numthreads workers that share the given state, the calling
+// thread being worker 0, and wait for all of them to return. Return 0, or
+// -1 without running fn at all if memory or threads run out.
+int run_workers(void *(*fn)(void *), void *shared, int numthreads);
+
+// Pin worker i of every later run_workers to the same CPU, dealing the CPUs
+// the process may use out one socket at a time; the calling thread is pinned
+// only while it runs worker 0. Return 0, or -1 if pinning is not supported.
+int workers_pin(int enabled);
+
+// Bounds of the contiguous slice of a size-element vector owned by worker id
+void slice_bounds(size_t size, int numthreads, int id, size_t *start, size_t *end);
+
+// Touch the pages of a newly allocated vector of size elements from the
+// workers that own its slices, so each page is placed in the memory of the
+// socket that will use it
+void first_touch(void *buffer, size_t element, size_t size, int numthreads);
+
+#endif